@@ -30,7 +30,8 @@ void app::setup() {
         DBGPRINTLN(F("false"));
 
     mSys.enableDebug();
-    mSys.setup(mConfig->nrf.amplifierPower, mConfig->nrf.pinIrq, mConfig->nrf.pinCe, mConfig->nrf.pinCs, mConfig->nrf.pinSclk, mConfig->nrf.pinMosi, mConfig->nrf.pinMiso);
+    mSys.setup(mConfig->nrf.amplifierPower, mConfig->nrf.pinIrq, mConfig->nrf.pinCe, mConfig->nrf.pinCs, mConfig->nrf.pinSclk, mConfig->nrf.pinMosi, mConfig->nrf.pinMiso,
+        mConfig->nrf.pinIrq2, mConfig->nrf.pinCe2, mConfig->nrf.pinCs2);
 
 #if defined(AP_ONLY)
     mInnerLoopCb = std::bind(&app::loopStandard, this);
@@ -47,11 +48,14 @@ void app::setup() {
 
     mPayload.setup(this, &mSys, &mStat, mConfig->nrf.maxRetransPerPyld, &mTimestamp);
     mPayload.enableSerialDebug(mConfig->serial.debug);
-    mPayload.addPayloadListener(std::bind(&app::payloadEventListener, this, std::placeholders::_1));
+    mPayload.addPayloadListener(std::bind(&app::payloadEventListener, this, std::placeholders::_1, std::placeholders::_2));
 
     mMiPayload.setup(this, &mSys, &mStat, mConfig->nrf.maxRetransPerPyld, &mTimestamp);
     mMiPayload.enableSerialDebug(mConfig->serial.debug);
-    mMiPayload.addPayloadListener(std::bind(&app::payloadEventListener, this, std::placeholders::_1));
+    mMiPayload.addPayloadListener(std::bind(&app::payloadEventListener, this, std::placeholders::_1, std::placeholders::_2));
+
+    mIvSched.setup(&mSys, &mPayload, &mMiPayload, &mStat, &mConfig->nrf.sendInterval);
+    mIvSched.enableSerialDebug(mConfig->serial.debug);
 
     // DBGPRINTLN("--- after payload");
     // DBGPRINTLN(String(ESP.getFreeHeap()));
@@ -102,35 +106,7 @@ void app::loop(void) {
 void app::loopStandard(void) {
     ah::Scheduler::loop();
 
-    if (mSys.Radio.loop()) {
-        while (!mSys.Radio.mBufCtrl.empty()) {
-            packet_t *p = &mSys.Radio.mBufCtrl.front();
-
-            if (mConfig->serial.debug) {
-                DPRINT(DBG_INFO, F("RX "));
-                DBGPRINT(String(p->len));
-                DBGPRINT(F("B Ch"));
-                DBGPRINT(String(p->ch));
-                DBGPRINT(F(" | "));
-                mSys.Radio.dumpBuf(p->packet, p->len);
-            }
-            mStat.frmCnt++;
-
-            Inverter<> *iv = mSys.findInverter(&p->packet[1]);
-            if (NULL != iv) {
-                if (IV_HM == iv->ivGen)
-                    mPayload.add(iv, p);
-                else
-                    mMiPayload.add(iv, p);
-            }
-            mSys.Radio.mBufCtrl.pop();
-            yield();
-        }
-        mPayload.process(true);
-        mMiPayload.process(true);
-    }
-    mPayload.loop();
-    mMiPayload.loop();
+    mIvSched.loop(mIVCommunicationOn);
 
     if (mMqttEnabled)
         mMqtt.loop();
@@ -149,7 +125,7 @@ void app::onWifi(bool gotIp) {
     regularTickers();  // reinstall regular tickers
     if (gotIp) {
         mInnerLoopCb = std::bind(&app::loopStandard, this);
-        every(std::bind(&app::tickSend, this), mConfig->nrf.sendInterval, "tSend");
+        everySec(std::bind(&app::tickSend, this), "tSend");  // deadlines are checked by sendNext()
         mMqttReconnect = true;
         mSunrise = 0;  // needs to be set to 0, to reinstall sunrise and ivComm tickers!
         once(std::bind(&app::tickNtpUpdate, this), 2, "ntp2");
@@ -248,6 +224,14 @@ void app::tickIVCommunication(void) {
         if (nxtTrig != 0)
             onceAt(std::bind(&app::tickIVCommunication, this), nxtTrig, "ivCom");
     }
+    if (!mIVCommunicationOn) {  // the break doesn't count as refresh age
+        mIvSched.stop();
+        for (uint8_t i = 0; i < MAX_NUM_INVERTERS; i++) {
+            Inverter<> *iv = mSys.getInverterByPos(i);
+            if (NULL != iv)
+                iv->pauseRefresh();
+        }
+    }
     tickComm();
 }
 
@@ -322,35 +306,27 @@ void app::tickMidnight(void) {
 
 //-----------------------------------------------------------------------------
 void app::tickSend(void) {
+    // the warnings are printed once per send interval
+    bool warn = ((millis() - mSendWarnMs) >= (mConfig->nrf.sendInterval * 1000UL));
+    if (warn)
+        mSendWarnMs = millis();
+
     if (!mSys.Radio.isChipConnected()) {
-        DPRINTLN(DBG_WARN, F("NRF24 not connected!"));
+        if (warn)
+            DPRINTLN(DBG_WARN, F("NRF24 not connected!"));
         return;
     }
     if (mIVCommunicationOn) {
         if (!mSys.Radio.mBufCtrl.empty()) {
-            if (mConfig->serial.debug) {
+            if (mConfig->serial.debug && warn) {
                 DPRINT(DBG_DEBUG, F("recbuf not empty! #"));
                 DBGPRINTLN(String(mSys.Radio.mBufCtrl.size()));
             }
         }
 
-        int8_t maxLoop = MAX_NUM_INVERTERS;
-        Inverter<> *iv = mSys.getInverterByPos(mSendLastIvId);
-        do {
-            mSendLastIvId = ((MAX_NUM_INVERTERS - 1) == mSendLastIvId) ? 0 : mSendLastIvId + 1;
-            iv = mSys.getInverterByPos(mSendLastIvId);
-        } while ((NULL == iv) && ((maxLoop--) > 0));
-
-        if (NULL != iv) {
-            if (iv->config->enabled) {
-                if (iv->ivGen == IV_HM)
-                    mPayload.ivSend(iv);
-                else
-                    mMiPayload.ivSend(iv);
-            }
-        }
+        mIvSched.sendNext();
     } else {
-        if (mConfig->serial.debug)
+        if (mConfig->serial.debug && warn)
             DPRINTLN(DBG_WARN, F("Time not set or it is night time, therefore no communication to the inverter!"));
     }
     yield();
@@ -373,7 +349,7 @@ void app::resetSystem(void) {
 
     mMqttEnabled = false;
 
-    mSendLastIvId = 0;
+    mSendWarnMs = 0;
     mShowRebootRequest = false;
     mIVCommunicationOn = true;
     mSavePending = false;
@@ -16,6 +16,7 @@
 #include "defines.h"
 #include "hm/hmPayload.h"
 #include "hm/hmSystem.h"
+#include "hm/ivScheduler.h"
 #include "hm/miPayload.h"
 #include "publisher/pubMqtt.h"
 #include "publisher/pubSerial.h"
@@ -35,6 +36,7 @@
 typedef HmSystem<MAX_NUM_INVERTERS> HmSystemType;
 typedef HmPayload<HmSystemType> PayloadType;
 typedef MiPayload<HmSystemType> MiPayloadType;
+typedef IvScheduler<HmSystemType, PayloadType, MiPayloadType> IvSchedulerType;
 typedef Web<HmSystemType> WebType;
 typedef RestApi<HmSystemType> RestApiType;
 typedef PubMqtt<HmSystemType> PubMqttType;
@@ -60,6 +62,10 @@ class app : public IApp, public ah::Scheduler {
             mSys.Radio.handleIntr();
         }
 
+        void handleIntr2(void) {
+            mSys.handleIntr2();
+        }
+
         uint32_t getUptime() {
             return Scheduler::getUptime();
         }
@@ -153,6 +159,15 @@ class app : public IApp, public ah::Scheduler {
             }
         }
 
+        // not inside the web request, the radio loop writes the capture
+        void setCaptureEnable(bool enable) {
+            once(std::bind(&RadioCapture::enable, &mSys.Capture, enable), 1, "capEn");
+        }
+
+        void clearCapture() {
+            once(std::bind(&RadioCapture::clear, &mSys.Capture), 1, "capCl");
+        }
+
         bool getMqttIsConnected() {
             return mMqtt.isConnected();
         }
@@ -173,6 +188,10 @@ class app : public IApp, public ah::Scheduler {
             return mConfig->nrf.pinIrq;
         }
 
+        uint8_t getIrqPin2(void) {
+            return mConfig->nrf.pinIrq2;
+        }
+
         String getTimeStr(uint32_t offset = 0) {
             char str[10];
             if(0 == mTimestamp)
@@ -210,13 +229,13 @@ class app : public IApp, public ah::Scheduler {
 
         void resetSystem(void);
 
-        void payloadEventListener(uint8_t cmd) {
+        void payloadEventListener(uint8_t cmd, Inverter<> *iv) {
             #if !defined(AP_ONLY)
             if (mMqttEnabled)
-                mMqtt.payloadEventListener(cmd);
+                mMqtt.payloadEventListener(cmd, iv);
             #endif
             if(mConfig->plugin.display.type != 0)
-               mDisplay.payloadEventListener(cmd);
+               mDisplay.payloadEventListener(cmd, iv);
         }
 
         void mqttSubRxCb(JsonObject obj);
@@ -276,6 +295,7 @@ class app : public IApp, public ah::Scheduler {
         RestApiType mApi;
         PayloadType mPayload;
         MiPayloadType mMiPayload;
+        IvSchedulerType mIvSched;
         PubSerialType mPubSerial;
 
         char mVersion[12];
@@ -284,7 +304,7 @@ class app : public IApp, public ah::Scheduler {
         bool mSavePending;
         bool mSaveReboot;
 
-        uint8_t mSendLastIvId;
+        uint32_t mSendWarnMs;
         bool mSendFirst;
 
         statistics_t mStat;
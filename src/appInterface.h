@@ -44,6 +44,8 @@ class IApp {
         virtual void setMqttPowerLimitAck(Inverter<> *iv) = 0;
 
         virtual void ivSendHighPrio(Inverter<> *iv) = 0;
+        virtual void setCaptureEnable(bool enable) = 0;
+        virtual void clearCapture() = 0;
 
         virtual bool getMqttIsConnected() = 0;
         virtual uint32_t getMqttRxCnt() = 0;
@@ -68,9 +68,18 @@
 // default NRF24 power, possible values (0 - 3)
 #define DEF_AMPLIFIERPOWER      1
 
-// number of packets hold in buffer
+// number of packets hold in buffer (max. 254)
 #define PACKET_BUFFER_SIZE      30
 
+// simulated RF medium instead of the NRF24 (see hm/simRadio.h), for testing
+// payload assembly and retransmits without inverters
+//#define ENABLE_SIM_RADIO
+
+// support for a second NRF24 which only receives (pins are configured in setup)
+#if defined(ESP32) && !defined(ENABLE_SIM_RADIO)
+    #define ENABLE_RX_RADIO
+#endif
+
 // number of configurable inverters
 #define MAX_NUM_INVERTERS       10
 
@@ -80,6 +89,24 @@
 // default send interval
 #define SEND_INTERVAL           30
 
+// polling period per command [s], the most overdue command is requested
+// next, live data is requested if nothing else is due. Alarms are requested
+// when the alarm message id of the live data increments.
+#define POLL_LIVE_SEC           0       // 0: each send interval
+#define POLL_LIMIT_SEC          300     // power limit (system config)
+#define POLL_INFO_SEC           86400   // firmware / hardware info
+
+// unanswered inverters (e.g. sleeping) are requested less often, the send
+// interval is doubled per failed request up to 2^REFRESH_BACKOFF_MAX times
+#define REFRESH_BACKOFF_MAX     5
+// a request including its retransmits ends at the latest after this time
+#define REFRESH_EXCHANGE_MS     5000
+
+// retransmit budget per inverter, learned from the retransmits the recent
+// requests needed and capped by the configured max. retransmits
+#define RETR_BUDGET_MIN         1       // budget of a reliable link
+#define RETR_OFFLINE_REQ        3       // requests in a row without any answer, no retransmits until it answers again
+
 // maximum human readable inverter name length
 #define MAX_NAME_LENGTH         16
 
@@ -89,6 +116,17 @@
 // maximum total payload buffers (must be greater than the number of received frame fragments)
 #define MAX_PAYLOAD_ENTRIES     10
 
+// inverter values are stored as integer with 3 decimals (utils/fixedPoint.h)
+// instead of float, decoding and publishing work without floating point
+//#define ENABLE_FIXED_POINT
+
+// number of pending requests per inverter (e.g. alarms, power limit read back)
+#define CMD_QUEUE_SIZE          6
+
+// number of payloads which are assembled at the same time (shared fragment
+// buffers), must be at least 1. A further request takes over the oldest one.
+#define MAX_PAYLOAD_INFLIGHT    2
+
 // maximum requests for retransmits per payload (per inverter)
 #define DEF_MAX_RETRANS_PER_PYLD 5
 
@@ -82,6 +82,10 @@ typedef struct {
     uint8_t pinMosi;
     uint8_t pinSclk;
     uint8_t amplifierPower;
+    // second NRF24, receive only, shares the SPI bus
+    uint8_t pinCs2;
+    uint8_t pinCe2;
+    uint8_t pinIrq2;
 } cfgNrf24_t;
 
 typedef struct {
@@ -358,6 +362,9 @@ class settings {
             mCfg.nrf.pinSclk           = DEF_SCLK_PIN;
 
             mCfg.nrf.amplifierPower    = DEF_AMPLIFIERPOWER & 0x03;
+            mCfg.nrf.pinCs2            = DEF_PIN_OFF;
+            mCfg.nrf.pinCe2            = DEF_PIN_OFF;
+            mCfg.nrf.pinIrq2           = DEF_PIN_OFF;
 
             snprintf(mCfg.ntp.addr, NTP_ADDR_LEN, "%s", DEF_NTP_SERVER_NAME);
             mCfg.ntp.port = DEF_NTP_PORT;
@@ -444,6 +451,9 @@ class settings {
                 obj[F("mosi")]      = mCfg.nrf.pinMosi;
                 obj[F("miso")]      = mCfg.nrf.pinMiso;
                 obj[F("pwr")]       = mCfg.nrf.amplifierPower;
+                obj[F("cs2")]       = mCfg.nrf.pinCs2;
+                obj[F("ce2")]       = mCfg.nrf.pinCe2;
+                obj[F("irq2")]      = mCfg.nrf.pinIrq2;
             } else {
                 getVal<uint16_t>(obj, F("intvl"), &mCfg.nrf.sendInterval);
                 getVal<uint8_t>(obj, F("maxRetry"), &mCfg.nrf.maxRetransPerPyld);
@@ -454,6 +464,9 @@ class settings {
                 getVal<uint8_t>(obj, F("mosi"), &mCfg.nrf.pinMosi);
                 getVal<uint8_t>(obj, F("miso"), &mCfg.nrf.pinMiso);
                 getVal<uint8_t>(obj, F("pwr"), &mCfg.nrf.amplifierPower);
+                getVal<uint8_t>(obj, F("cs2"), &mCfg.nrf.pinCs2);
+                getVal<uint8_t>(obj, F("ce2"), &mCfg.nrf.pinCe2);
+                getVal<uint8_t>(obj, F("irq2"), &mCfg.nrf.pinIrq2);
                 if((obj[F("cs")] == obj[F("ce")])) {
                     mCfg.nrf.pinCs   = DEF_CS_PIN;
                     mCfg.nrf.pinCe   = DEF_CE_PIN;
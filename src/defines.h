@@ -19,6 +19,7 @@
 typedef struct {
     uint8_t ch;
     uint8_t len;
+    uint32_t ts; // micros() of reception, orders the packets of several radios
     uint8_t packet[MAX_RF_PAYLOAD_SIZE];
 } packet_t;
 
@@ -99,7 +100,10 @@ typedef struct {
     uint32_t rxFail;
     uint32_t rxFailNoAnser;
     uint32_t rxSuccess;
-    uint32_t frmCnt;
+    uint32_t frmCnt;         // useful fragments, without duplicates
+    uint32_t frmDup;         // dropped duplicate fragments
+    uint32_t rxBufOverflow;  // fragments dropped because the RX ring was full (all radios)
+    uint32_t rxBufHighWater; // max. number of fragments waiting in the RX ring (max. of all radios)
 } statistics_t;
 
 #endif /*__DEFINES_H__*/
@@ -0,0 +1,121 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __ASSIGN_DECODER_H__
+#define __ASSIGN_DECODER_H__
+
+#include <cstdint>
+#include "hmDefines.h"
+#include "../utils/fixedPoint.h"
+
+//-----------------------------------------------------------------------------
+// decoders generated at compile time from the constexpr assignment tables.
+// Each field is unrolled with its position, length and divisor as constants;
+// the results are the same as the ones of the table interpreter interpret().
+// T is the record (record_t), values are stored with T::set() which tracks the
+// changed fields.
+//-----------------------------------------------------------------------------
+namespace assignDecoder {
+    // big endian value of NUM bytes starting at start
+    template <uint8_t NUM>
+    struct BigEndian {
+        template <class BUF>
+        static inline uint32_t read(const BUF &buf, uint8_t start) {
+            return (BigEndian<NUM - 1>::read(buf, start) << 8) | buf[start + NUM - 1];
+        }
+    };
+
+    template <>
+    struct BigEndian<1> {
+        template <class BUF>
+        static inline uint32_t read(const BUF &buf, uint8_t start) {
+            return buf[start];
+        }
+    };
+
+    // entry POS of table A, calculated fields are evaluated on read (Inverter::getValue())
+    template <const byteAssign_t *A, uint8_t POS, bool CALC = (CMD_CALC == A[POS].div)>
+    struct Field {
+        template <class T, class BUF>
+        static inline void decode(T *rec, const BUF &buf, const int32_t yieldCor[]) {
+            typedef typename T::value_type VAL;
+            uint32_t val = BigEndian<A[POS].num>::read(buf, A[POS].start);
+            if(FLD_T == A[POS].fieldId) // temperature is a signed value!
+                rec->set(POS, ah::scaleValue<VAL>((int32_t)((int16_t)val), A[POS].div));
+            else if(FLD_YT == A[POS].fieldId)
+                rec->set(POS, ah::scaleValue<VAL>(val, A[POS].div) + ((VAL)yieldCor[A[POS].ch - 1]));
+            else
+                rec->set(POS, ah::scaleValue<VAL>(val, A[POS].div));
+        }
+    };
+
+    template <const byteAssign_t *A, uint8_t POS>
+    struct Field<A, POS, true> {
+        template <class T, class BUF>
+        static inline void decode(T *, const BUF &, const int32_t []) {}
+    };
+
+    // entries POS to LEN - 1 of table A
+    template <const byteAssign_t *A, uint8_t POS, uint8_t LEN>
+    struct Record {
+        template <class T, class BUF>
+        static inline void decode(T *rec, const BUF &buf, const int32_t yieldCor[]) {
+            Field<A, POS>::decode(rec, buf, yieldCor);
+            Record<A, POS + 1, LEN>::decode(rec, buf, yieldCor);
+        }
+    };
+
+    template <const byteAssign_t *A, uint8_t LEN>
+    struct Record<A, LEN, LEN> {
+        template <class T, class BUF>
+        static inline void decode(T *, const BUF &, const int32_t []) {}
+    };
+
+    // table interpreter, decodes entry pos of the records table
+    template <class T, class BUF>
+    void interpret(T *rec, uint8_t pos, const BUF &buf, const int32_t yieldCor[]) {
+        typedef typename T::value_type VAL;
+        uint8_t  ptr = rec->assign[pos].start;
+        uint8_t  end = ptr + rec->assign[pos].num;
+        uint16_t div = rec->assign[pos].div;
+
+        if(CMD_CALC != div) {
+            uint32_t val = 0;
+            do {
+                val <<= 8;
+                val |= buf[ptr];
+            } while(++ptr != end);
+            if (FLD_T == rec->assign[pos].fieldId) {
+                // temperature is a signed value!
+                rec->set(pos, ah::scaleValue<VAL>((int32_t)((int16_t)val), div));
+            } else if (FLD_YT == rec->assign[pos].fieldId) {
+                rec->set(pos, ah::scaleValue<VAL>(val, div) + ((VAL)yieldCor[rec->assign[pos].ch-1]));
+            } else
+                rec->set(pos, ah::scaleValue<VAL>(val, div));
+        }
+    }
+
+    // returns false if there is no decoder for the table
+    template <class T, class BUF>
+    bool decode(const byteAssign_t *assign, T *rec, const BUF &buf, const int32_t yieldCor[]) {
+        if(hm1chAssignment == assign)
+            Record<hm1chAssignment, 0, HM1CH_LIST_LEN>::decode(rec, buf, yieldCor);
+        else if(hm2chAssignment == assign)
+            Record<hm2chAssignment, 0, HM2CH_LIST_LEN>::decode(rec, buf, yieldCor);
+        else if(hm4chAssignment == assign)
+            Record<hm4chAssignment, 0, HM4CH_LIST_LEN>::decode(rec, buf, yieldCor);
+        else if(InfoAssignment == assign)
+            Record<InfoAssignment, 0, HMINFO_LIST_LEN>::decode(rec, buf, yieldCor);
+        else if(SystemConfigParaAssignment == assign)
+            Record<SystemConfigParaAssignment, 0, HMSYSTEM_LIST_LEN>::decode(rec, buf, yieldCor);
+        else if(AlarmDataAssignment == assign)
+            Record<AlarmDataAssignment, 0, HMALARMDATA_LIST_LEN>::decode(rec, buf, yieldCor);
+        else
+            return false;
+        return true;
+    }
+}
+
+#endif /*__ASSIGN_DECODER_H__*/
@@ -0,0 +1,56 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __ASSIGN_INDEX_H__
+#define __ASSIGN_INDEX_H__
+
+#include <cstdint>
+#include <cstring>
+#include "hmDefines.h"
+
+#define ASSIGN_IDX_CH       (CH4 + 1)
+#define ASSIGN_IDX_FLD      (FLD_LAST_ALARM_CODE + 1)
+#define ASSIGN_IDX_SLOTS    8    // number of different assignment tables
+#define ASSIGN_IDX_NONE     0xff
+
+//-----------------------------------------------------------------------------
+// (channel, field) -> position lookup of an assignment table. The index is
+// built once per table and shared by all inverters which use the table.
+// Returns NULL if all slots are used, the caller has to search the table then.
+//-----------------------------------------------------------------------------
+namespace assignIndex {
+    inline const uint8_t *get(const byteAssign_t *assign, uint8_t len) {
+        typedef struct {
+            const byteAssign_t *assign;
+            uint8_t *idx;
+        } slot_t;
+        static slot_t slot[ASSIGN_IDX_SLOTS] = {};
+
+        if(NULL == assign)
+            return NULL;
+        for(uint8_t i = 0; i < ASSIGN_IDX_SLOTS; i++) {
+            if(assign == slot[i].assign)
+                return slot[i].idx;
+            if(NULL != slot[i].assign)
+                continue;
+
+            // first use of this table, the first match of a pair wins like
+            // the search does
+            uint8_t *idx = new uint8_t[ASSIGN_IDX_CH * ASSIGN_IDX_FLD];
+            memset(idx, ASSIGN_IDX_NONE, ASSIGN_IDX_CH * ASSIGN_IDX_FLD);
+            for(uint8_t pos = len; pos > 0; pos--) {
+                const byteAssign_t *a = &assign[pos - 1];
+                if((a->ch < ASSIGN_IDX_CH) && (a->fieldId < ASSIGN_IDX_FLD))
+                    idx[a->ch * ASSIGN_IDX_FLD + a->fieldId] = pos - 1;
+            }
+            slot[i].assign = assign;
+            slot[i].idx    = idx;
+            return idx;
+        }
+        return NULL;
+    }
+}
+
+#endif /*__ASSIGN_INDEX_H__*/
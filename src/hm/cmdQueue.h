@@ -0,0 +1,125 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __CMD_QUEUE_H__
+#define __CMD_QUEUE_H__
+
+#include <cstdint>
+#include <cstring>
+#include <Arduino.h>
+
+#define CMD_TX_INFO         0x15 // same as TX_REQ_INFO
+
+enum {CMD_PRIO_NORMAL = 0, CMD_PRIO_HIGH};
+
+typedef struct {
+    uint8_t    txType;      // request type, e.g. CMD_TX_INFO
+    uint8_t    cmd;
+    uint16_t   arg;
+    uint32_t   enqMs;       // millis() when it was enqueued
+    uint8_t    prio;        // CMD_PRIO_*
+} cmdEntry_t;
+
+//-----------------------------------------------------------------------------
+// pending commands of one inverter, no heap allocation. Commands with higher
+// priority are placed in front of the lower ones, equal priorities keep their
+// order. A command which is already pending is not added again.
+//-----------------------------------------------------------------------------
+template <uint8_t SIZE>
+class CmdQueue {
+    public:
+        CmdQueue() : mHead(0), mCnt(0), mHighWater(0), mDupCnt(0), mOverflow(0), mMaxWaitMs(0) {}
+
+        // returns false if the command was dropped (duplicate or full queue)
+        bool push(uint8_t txType, uint8_t cmd, uint16_t arg = 0, uint8_t prio = CMD_PRIO_NORMAL) {
+            for(uint8_t i = 0; i < mCnt; i++) {
+                cmdEntry_t *e = at(i);
+                if((e->txType == txType) && (e->cmd == cmd) && (e->arg == arg)) {
+                    mDupCnt++;
+                    return false;
+                }
+            }
+            if(mCnt >= SIZE) {
+                mOverflow++;
+                return false;
+            }
+
+            uint8_t pos = mCnt;
+            while((pos > 0) && (at(pos - 1)->prio < prio)) {
+                *at(pos) = *at(pos - 1);
+                pos--;
+            }
+            cmdEntry_t *e = at(pos);
+            e->txType = txType;
+            e->cmd    = cmd;
+            e->arg    = arg;
+            e->enqMs  = millis();
+            e->prio   = prio;
+
+            if(++mCnt > mHighWater)
+                mHighWater = mCnt;
+            return true;
+        }
+
+        // oldest command of the highest priority, NULL if empty
+        cmdEntry_t *front(void) {
+            return (0 == mCnt) ? NULL : at(0);
+        }
+
+        void pop(void) {
+            if(0 == mCnt)
+                return;
+            uint32_t wait = millis() - at(0)->enqMs;
+            if(wait > mMaxWaitMs)
+                mMaxWaitMs = wait;
+            mHead = (mHead + 1) % SIZE;
+            mCnt--;
+        }
+
+        void clear(void) {
+            mHead = 0;
+            mCnt  = 0;
+        }
+
+        bool empty(void) const {
+            return (0 == mCnt);
+        }
+
+        uint8_t size(void) const {
+            return mCnt;
+        }
+
+        uint8_t getHighWater(void) const {
+            return mHighWater;
+        }
+
+        uint32_t getDupCnt(void) const {
+            return mDupCnt;
+        }
+
+        uint32_t getOverflowCnt(void) const {
+            return mOverflow;
+        }
+
+        // longest time a command was pending [ms]
+        uint32_t getMaxWaitMs(void) const {
+            return mMaxWaitMs;
+        }
+
+    private:
+        inline cmdEntry_t *at(uint8_t idx) {
+            return &mBuf[(mHead + idx) % SIZE];
+        }
+
+        cmdEntry_t mBuf[SIZE];
+        uint8_t mHead;
+        uint8_t mCnt;
+        uint8_t mHighWater;
+        uint32_t mDupCnt;
+        uint32_t mOverflow;
+        uint32_t mMaxWaitMs;
+};
+
+#endif /*__CMD_QUEUE_H__*/
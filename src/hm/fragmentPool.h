@@ -0,0 +1,165 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __FRAGMENT_POOL_H__
+#define __FRAGMENT_POOL_H__
+
+#include <cstdint>
+#include <cstring>
+#include "../config/config.h"
+
+#define FRAG_DATA_SIZE      (MAX_RF_PAYLOAD_SIZE - 11) // without header and crc8
+#define FRAG_POOL_FREE      0xff
+
+//-----------------------------------------------------------------------------
+// reads a payload which is spread over several fragments like one buffer,
+// decoding doesn't need a contiguous copy
+//-----------------------------------------------------------------------------
+class FragmentReader {
+    public:
+        FragmentReader() : mCnt(0), mLen(0), mFragLen(0), mUniform(true) {}
+
+        void add(const uint8_t *data, uint8_t len) {
+            if(mCnt >= MAX_PAYLOAD_ENTRIES)
+                return;
+            if(0 == mCnt)
+                mFragLen = len;
+            else if((mFragLen != mFragSize[mCnt - 1]) || (len > mFragLen))
+                mUniform = false; // only the last fragment may be shorter
+            mFrag[mCnt]     = data;
+            mFragSize[mCnt] = len;
+            mCnt++;
+            mLen += len;
+        }
+
+        // cuts the last len bytes, e.g. the crc16
+        void trim(uint8_t len) {
+            while((len > 0) && (mCnt > 0)) {
+                uint8_t n = (len > mFragSize[mCnt - 1]) ? mFragSize[mCnt - 1] : len;
+                mFragSize[mCnt - 1] -= n;
+                mLen -= n;
+                len  -= n;
+                if(0 == mFragSize[mCnt - 1])
+                    mCnt--;
+            }
+        }
+
+        uint8_t length(void) const {
+            return mLen;
+        }
+
+        uint8_t fragments(void) const {
+            return mCnt;
+        }
+
+        const uint8_t *fragment(uint8_t idx) const {
+            return mFrag[idx];
+        }
+
+        uint8_t fragmentLen(uint8_t idx) const {
+            return mFragSize[idx];
+        }
+
+        // positions behind the end read as 0 like the zeroed copy did before
+        uint8_t operator[](uint8_t pos) const {
+            if(pos >= mLen)
+                return 0;
+            if(mUniform && (0 != mFragLen))
+                return mFrag[pos / mFragLen][pos % mFragLen];
+            uint8_t i = 0;
+            while(pos >= mFragSize[i])
+                pos -= mFragSize[i++];
+            return mFrag[i][pos];
+        }
+
+    private:
+        const uint8_t *mFrag[MAX_PAYLOAD_ENTRIES];
+        uint8_t mFragSize[MAX_PAYLOAD_ENTRIES];
+        uint8_t mCnt;
+        uint8_t mLen;
+        uint8_t mFragLen;
+        bool mUniform;
+};
+
+//-----------------------------------------------------------------------------
+// fragment buffers shared by all inverters, one slot holds the fragments of
+// one request. If all slots are in use the least recently assigned one is
+// taken over, its previous owner has to forget the received fragments.
+//-----------------------------------------------------------------------------
+template <uint8_t SLOTS>
+class FragmentPool {
+    public:
+        FragmentPool() : mSeq(0) {
+            for(uint8_t i = 0; i < SLOTS; i++) {
+                mSlot[i].owner = FRAG_POOL_FREE;
+                mSlot[i].seq   = 0;
+            }
+        }
+
+        // buffer of fragment idx, assigns a slot to the owner if required.
+        // evicted is set to the owner which lost its slot or FRAG_POOL_FREE
+        uint8_t *get(uint8_t owner, uint8_t idx, uint8_t *evicted) {
+            *evicted = FRAG_POOL_FREE;
+            if(idx >= MAX_PAYLOAD_ENTRIES)
+                return NULL;
+            slot_t *s = find(owner);
+            if(NULL == s) {
+                s = &mSlot[0];
+                for(uint8_t i = 1; i < SLOTS; i++) {
+                    if(FRAG_POOL_FREE == s->owner)
+                        break;
+                    if((FRAG_POOL_FREE == mSlot[i].owner) || ((int32_t)(mSlot[i].seq - s->seq) < 0))
+                        s = &mSlot[i];
+                }
+                *evicted = s->owner;
+                s->owner = owner;
+                s->seq   = ++mSeq;
+            }
+            return s->data[idx];
+        }
+
+        // NULL if the owner has no slot
+        uint8_t *peek(uint8_t owner, uint8_t idx) {
+            slot_t *s = find(owner);
+            if((NULL == s) || (idx >= MAX_PAYLOAD_ENTRIES))
+                return NULL;
+            return s->data[idx];
+        }
+
+        void release(uint8_t owner) {
+            slot_t *s = find(owner);
+            if(NULL != s)
+                s->owner = FRAG_POOL_FREE;
+        }
+
+        uint8_t getUsed(void) {
+            uint8_t cnt = 0;
+            for(uint8_t i = 0; i < SLOTS; i++) {
+                if(FRAG_POOL_FREE != mSlot[i].owner)
+                    cnt++;
+            }
+            return cnt;
+        }
+
+    private:
+        typedef struct {
+            uint8_t  owner;
+            uint32_t seq;
+            uint8_t  data[MAX_PAYLOAD_ENTRIES][FRAG_DATA_SIZE];
+        } slot_t;
+
+        slot_t *find(uint8_t owner) {
+            for(uint8_t i = 0; i < SLOTS; i++) {
+                if(owner == mSlot[i].owner)
+                    return &mSlot[i];
+            }
+            return NULL;
+        }
+
+        slot_t mSlot[SLOTS];
+        uint32_t mSeq;
+};
+
+#endif /*__FRAGMENT_POOL_H__*/
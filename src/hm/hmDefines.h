@@ -7,6 +7,7 @@
 #define __HM_DEFINES_H__
 
 #include "../utils/dbg.h"
+#include "../utils/histogram.h"
 #include <cstdint>
 
 // inverter generations
@@ -33,6 +34,12 @@ const uint8_t fieldUnits[] = {UNIT_V, UNIT_A, UNIT_W, UNIT_WH, UNIT_KWH, UNIT_KW
         UNIT_V, UNIT_A, UNIT_W, UNIT_HZ, UNIT_C, UNIT_NONE, UNIT_PCT, UNIT_PCT, UNIT_VAR,
         UNIT_NONE, UNIT_NONE, UNIT_NONE, UNIT_NONE, UNIT_NONE, UNIT_NONE, UNIT_PCT, UNIT_NONE};
 
+// smallest change of a field which is propagated to the listeners [1/1000 of
+// the unit], 0: every change counts, e.g. 500 for FLD_UDC ignores +-0.499V
+const uint16_t fieldDeadband[] = {0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0};
+
 // mqtt discovery device classes
 enum {DEVICE_CLS_NONE = 0, DEVICE_CLS_CURRENT, DEVICE_CLS_ENERGY, DEVICE_CLS_PWR, DEVICE_CLS_VOLTAGE, DEVICE_CLS_FREQ, DEVICE_CLS_TEMP};
 const char* const deviceClasses[] = {0, "current", "energy", "power", "voltage", "frequency", "temperature"};
@@ -71,6 +78,119 @@ enum {CH0 = 0, CH1, CH2, CH3, CH4};
 
 enum {INV_TYPE_1CH = 0, INV_TYPE_2CH, INV_TYPE_4CH};
 
+// number of used RF channels (2403, 2423, 2440, 2461, 2475MHz)
+#define RF_CHANNELS         5
+
+// channel quality is a moving average from 0 (never delivers) to 255 (always delivers)
+#define RF_CH_QUALITY_INIT  128
+#define RF_CH_QUALITY_MIN   64  // TX channels below this value are skipped
+#define RF_CH_QUALITY_PROBE 4   // recovery per skip, so bad channels get probed again
+#define RF_CH_QUALITY_LEAD  64  // an RX channel is listened earlier only if it is better by this value
+#define RF_HOP_EXPLORE      4   // every 4th listen window keeps the default hop order
+
+// radio statistics, kept per inverter for each RF channel
+typedef struct {
+    uint32_t   frames;    // received fragments with valid crc8
+    uint32_t   crcFail;   // received fragments with invalid crc8
+    uint32_t   ttff;      // moving average of time from request to first fragment [us]
+    uint8_t    rxQuality; // share of dwells on this RX channel which delivered fragments
+    uint8_t    txQuality; // share of requests on this TX channel which were answered
+} rfChStat_t;
+
+#define RF_RX_OFFSET_DEFAULT 2 // inverters answer two channels above the TX channel
+
+// learned answer behaviour of one inverter
+typedef struct {
+    uint8_t    offsetHits[RF_CHANNELS]; // first fragments seen per RX channel offset to the TX channel
+    uint32_t   delay;                   // moving average of the first fragment arrival after TX [us]
+} rfRxModel_t;
+
+#define RF_PA_UNSET         0xff // no level chosen yet, the configured one (also the maximum) is used
+#define RF_PA_EVAL_REQ      16   // requests per evaluation of the PA level
+#define RF_PA_RAISE_PCT     75   // raise the level if less requests were answered
+#define RF_PA_LOWER_EVALS   4    // evaluations without loss in a row before the level is lowered
+
+// transmit power control of one inverter
+typedef struct {
+    uint8_t    level;       // PA level used for this inverter (0: MIN - 3: MAX)
+    uint8_t    requests;    // requests since the last evaluation
+    uint8_t    answered;    // requests which got at least one fragment
+    uint8_t    retransmits; // retransmit requests since the last evaluation
+    uint8_t    goodEvals;   // evaluations without loss in a row
+} rfPaCtrl_t;
+
+// latency statistics, kept per inverter for each request class
+enum {RF_LAT_REALTIME = 0, RF_LAT_INFO, RF_LAT_ALARM, RF_LAT_CTRL, RF_LAT_CMDS};
+const char* const rfLatCmdNames[] = {"realtime", "info", "alarm", "devcontrol"};
+
+#define RF_LAT_BUCKETS      8
+const uint16_t rfLatBounds[RF_LAT_BUCKETS - 1] = {25, 50, 100, 200, 400, 800, 1600}; // [ms]
+#define RF_RETR_BUCKETS     5
+const uint16_t rfRetrBounds[RF_RETR_BUCKETS - 1] = {0, 1, 2, 3};
+
+typedef struct {
+    ah::Histogram<RF_LAT_BUCKETS>  first;       // TX to first fragment [ms]
+    ah::Histogram<RF_LAT_BUCKETS>  last;        // TX to last fragment [ms]
+    ah::Histogram<RF_LAT_BUCKETS>  payload;     // TX to crc checked payload [ms]
+    ah::Histogram<RF_RETR_BUCKETS> retransmits; // retransmits per payload
+} rfLatency_t;
+
+#define RF_WINDOW_MIN_MS    30   // shortest learned listen window
+
+// learned answer timing of one request class, sizes the listen window
+typedef struct {
+    uint32_t   lastUs;      // moving average of TX to last fragment [us]
+    uint32_t   spanUs;      // moving average of first to last fragment [us]
+} rfWindow_t;
+
+#define RX_SIG_SIZE         16   // fragment signatures kept per inverter and request
+
+// received fragments of the running request, detects duplicates
+typedef struct {
+    uint32_t   sig[RX_SIG_SIZE]; // pid, length and crc16 of the fragment
+    uint8_t    cnt;
+    uint8_t    idx;              // next entry to overwrite
+    uint32_t   dupCnt;           // dropped duplicates
+} rfRxDup_t;
+
+// result of a request, adapts the retransmit budget
+enum {RF_RETR_OK = 0, RF_RETR_PARTIAL, RF_RETR_NONE};
+
+typedef struct {
+    uint16_t   avg;         // moving average of the needed retransmits [1/16]
+    uint8_t    noAnswer;    // requests in a row without any fragment
+    uint8_t    budget;      // retransmits of the running request
+    bool       learned;     // avg is valid
+} rfRetrCtrl_t;
+
+// periodically polled commands, in the order they are preferred if equally overdue
+enum {POLL_INFO = 0, POLL_LIMIT, POLL_LIVE, POLL_CMDS};
+
+typedef struct {
+    uint32_t   periodMs;
+    uint32_t   dueMs;       // millis() when the command is due again
+} pollSched_t;
+
+#define REFRESH_BUCKETS     7
+const uint16_t refreshAgeBounds[REFRESH_BUCKETS - 1] = {10, 20, 40, 80, 160, 320}; // [s]
+
+// freshness of the inverter data, the inverter with the oldest deadline is requested next
+typedef struct {
+    uint32_t   dueMs;       // millis() when the inverter is requested again
+    uint32_t   lastMs;      // millis() of the last complete answer, 0: none yet
+    uint8_t    backoff;     // requests in a row without complete answer
+    ah::Histogram<REFRESH_BUCKETS> age; // time between two complete answers [s]
+} ivRefresh_t;
+
+// timing of the running request
+typedef struct {
+    uint32_t   txUs;    // micros() of the first transmission
+    uint8_t    cmd;     // RF_LAT_* class
+    bool       first;   // first fragment was counted
+    bool       last;    // last fragment was counted
+    bool       running;
+} rfLatReq_t;
+
 
 typedef struct {
     uint8_t    fieldId; // field id
@@ -90,7 +210,7 @@ typedef struct {
 //-------------------------------------
 // HM-Series
 //-------------------------------------
-const byteAssign_t InfoAssignment[] = {
+constexpr byteAssign_t InfoAssignment[] = {
     { FLD_FW_VERSION,           UNIT_NONE,   CH0,  0, 2, 1 },
     { FLD_FW_BUILD_YEAR,        UNIT_NONE,   CH0,  2, 2, 1 },
     { FLD_FW_BUILD_MONTH_DAY,   UNIT_NONE,   CH0,  4, 2, 1 },
@@ -100,7 +220,7 @@ const byteAssign_t InfoAssignment[] = {
 #define HMINFO_LIST_LEN     (sizeof(InfoAssignment) / sizeof(byteAssign_t))
 #define HMINFO_PAYLOAD_LEN  14
 
-const byteAssign_t SystemConfigParaAssignment[] = {
+constexpr byteAssign_t SystemConfigParaAssignment[] = {
     { FLD_ACT_ACTIVE_PWR_LIMIT,    UNIT_PCT,   CH0,  2, 2, 10   }/*,
     { FLD_ACT_REACTIVE_PWR_LIMIT,  UNIT_PCT,   CH0,  4, 2, 10   },
     { FLD_ACT_PF,                  UNIT_NONE,  CH0,  6, 2, 1000 }*/
@@ -108,7 +228,7 @@ const byteAssign_t SystemConfigParaAssignment[] = {
 #define HMSYSTEM_LIST_LEN     (sizeof(SystemConfigParaAssignment) / sizeof(byteAssign_t))
 #define HMSYSTEM_PAYLOAD_LEN  14
 
-const byteAssign_t AlarmDataAssignment[] = {
+constexpr byteAssign_t AlarmDataAssignment[] = {
     { FLD_LAST_ALARM_CODE,           UNIT_NONE,   CH0,  0, 2, 1 }
 };
 #define HMALARMDATA_LIST_LEN     (sizeof(AlarmDataAssignment) / sizeof(byteAssign_t))
@@ -119,7 +239,7 @@ const byteAssign_t AlarmDataAssignment[] = {
 //-------------------------------------
 // HM300, HM350, HM400
 //-------------------------------------
-const byteAssign_t hm1chAssignment[] = {
+constexpr byteAssign_t hm1chAssignment[] = {
     { FLD_UDC, UNIT_V,    CH1,  2, 2, 10   },
     { FLD_IDC, UNIT_A,    CH1,  4, 2, 100  },
     { FLD_PDC, UNIT_W,    CH1,  6, 2, 10   },
@@ -147,7 +267,7 @@ const byteAssign_t hm1chAssignment[] = {
 //-------------------------------------
 // HM600, HM700, HM800
 //-------------------------------------
-const byteAssign_t hm2chAssignment[] = {
+constexpr byteAssign_t hm2chAssignment[] = {
     { FLD_UDC, UNIT_V,    CH1,  2, 2, 10   },
     { FLD_IDC, UNIT_A,    CH1,  4, 2, 100  },
     { FLD_PDC, UNIT_W,    CH1,  6, 2, 10   },
@@ -183,7 +303,7 @@ const byteAssign_t hm2chAssignment[] = {
 //-------------------------------------
 // HM1200, HM1500
 //-------------------------------------
-const byteAssign_t hm4chAssignment[] = {
+constexpr byteAssign_t hm4chAssignment[] = {
     { FLD_UDC, UNIT_V,    CH1,  2, 2, 10   },
     { FLD_IDC, UNIT_A,    CH1,  4, 2, 100  },
     { FLD_PDC, UNIT_W,    CH1,  8, 2, 10   },
@@ -226,6 +346,7 @@ const byteAssign_t hm4chAssignment[] = {
     { FLD_EFF, UNIT_PCT,  CH0, CALC_EFF_CH0, 0, CMD_CALC }
 };
 #define HM4CH_LIST_LEN      (sizeof(hm4chAssignment) / sizeof(byteAssign_t))
+static_assert(HM4CH_LIST_LEN <= 64, "record_t::dirty holds 64 fields");
 #define HM4CH_PAYLOAD_LEN   62
 
 
@@ -12,9 +12,12 @@
 #endif
 
 #include "hmDefines.h"
-#include <memory>
-#include <queue>
+#include "cmdQueue.h"
+#include "assignIndex.h"
+#include "assignDecoder.h"
 #include "../config/settings.h"
+#include "../utils/fixedPoint.h"
+#include "../utils/crc.h"
 
 /**
  * For values which are of interest and not transmitted by the inverter can be
@@ -23,75 +26,85 @@
  * automatically. Their result does not differ from original read values.
  */
 
+// type of the stored values
+#if defined(ENABLE_FIXED_POINT)
+typedef ah::Fixed recVal_t;
+#else
+typedef float recVal_t;
+#endif
+
 // forward declaration of class
-template <class REC_TYP=float>
+template <class REC_TYP=recVal_t>
 class Inverter;
 
 
 // prototypes
-template<class T=float>
+template<class T=recVal_t>
 static T calcYieldTotalCh0(Inverter<> *iv, uint8_t arg0);
 
-template<class T=float>
+template<class T=recVal_t>
 static T calcYieldDayCh0(Inverter<> *iv, uint8_t arg0);
 
-template<class T=float>
+template<class T=recVal_t>
 static T calcUdcCh(Inverter<> *iv, uint8_t arg0);
 
-template<class T=float>
+template<class T=recVal_t>
 static T calcPowerDcCh0(Inverter<> *iv, uint8_t arg0);
 
-template<class T=float>
+template<class T=recVal_t>
 static T calcEffiencyCh0(Inverter<> *iv, uint8_t arg0);
 
-template<class T=float>
+template<class T=recVal_t>
 static T calcIrradiation(Inverter<> *iv, uint8_t arg0);
 
-template<class T=float>
+template<class T=recVal_t>
 using func_t = T (Inverter<> *, uint8_t);
 
-template<class T=float>
+template<class T=recVal_t>
 struct calcFunc_t {
     uint8_t funcId; // unique id
     func_t<T>*  func;   // function pointer
 };
 
-template<class T=float>
+template<class T=recVal_t>
 struct record_t {
+    typedef T value_type;
+
     byteAssign_t* assign; // assigment of bytes in payload
     uint8_t length;       // length of the assignment list
     T *record;            // data pointer
     uint32_t ts;          // timestamp of last received payload
     uint8_t pyldLen;      // expected payload length for plausibility check
-};
-
-class CommandAbstract {
-    public:
-        CommandAbstract(uint8_t txType = 0, uint8_t cmd = 0) {
-            _TxType = txType;
-            _Cmd = cmd;
-        };
-        virtual ~CommandAbstract() {};
-
-        const uint8_t getCmd() {
-            return _Cmd;
-        }
-
-    protected:
-        uint8_t _TxType;
-        uint8_t _Cmd;
-};
-
-class InfoCommand : public CommandAbstract {
-    public:
-        InfoCommand(uint8_t cmd){
-            _TxType = 0x15;
-            _Cmd = cmd;
+    const uint8_t *idx;   // (channel, field) -> position, NULL: search assign
+    uint64_t dirty;       // bit per position, changed since the last notification
+    T *ref;               // last propagated values, NULL: no field has a deadband
+    uint32_t gen;         // update generation, incremented by every changed value
+    uint64_t calcMask;    // bit per position of the calculated fields (CMD_CALC)
+    uint32_t *calcGen;    // generation of each calculated value, NULL: none
+
+    // stores the value, marks the field dirty if it changed by at least its
+    // deadband. The calculated fields are marked on every change of a value,
+    // they are evaluated when they are read.
+    void set(uint8_t pos, const T &val) {
+        if(val == record[pos])
+            return;
+        record[pos] = val;
+        gen++;
+        dirty |= calcMask;
+        if(NULL != ref) {
+            uint16_t deadband = fieldDeadband[assign[pos].fieldId];
+            if(0 != deadband) {
+                if(ah::absMilli(val - ref[pos]) < deadband)
+                    return;
+                ref[pos] = val;
+            }
         }
+        dirty |= (1ULL << pos);
+    }
 };
 
 // list of all available functions, mapped in hmDefines.h
-template<class T=float>
+template<class T=recVal_t>
 const calcFunc_t<T> calcFunctions[] = {
     { CALC_YT_CH0,  &calcYieldTotalCh0 },
     { CALC_YD_CH0,  &calcYieldDayCh0   },
@@ -122,6 +135,17 @@ class Inverter {
         //String        lastAlarmMsg;
         bool          initialized;       // needed to check if the inverter was correctly added (ESP32 specific - union types are never null)
         bool          isConnected;       // shows if inverter was successfully identified (fw version and hardware info)
+        rfChStat_t    rfStat[RF_CHANNELS]; // radio statistics per RF channel
+        rfRxModel_t   rfModel;           // learned RX channel offset and answer delay
+        rfPaCtrl_t    rfPa;              // transmit power control
+        rfLatency_t   rfLat[RF_LAT_CMDS]; // latency histograms per request class
+        rfLatReq_t    rfLatReq;          // timing of the running request
+        rfWindow_t    rfWin[RF_LAT_CMDS]; // learned listen window per request class
+        rfRxDup_t     rfDup;             // duplicate detection of the running request
+        pollSched_t   poll[POLL_CMDS];   // polling schedule of the periodic commands
+        ivRefresh_t   refresh;           // data freshness and deadline of the next request
+        rfRetrCtrl_t  rfRetr;            // retransmit budget
+        CmdQueue<CMD_QUEUE_SIZE> cmdQueue; // pending requests
 
         Inverter() {
             ivGen              = IV_HM;
@@ -134,55 +158,94 @@ class Inverter {
             //lastAlarmMsg       = "nothing";
             alarmMesIndex      = 0;
             isConnected        = false;
+            for(uint8_t i = 0; i < RF_CHANNELS; i++) {
+                memset(&rfStat[i], 0, sizeof(rfChStat_t));
+                rfStat[i].rxQuality = RF_CH_QUALITY_INIT;
+                rfStat[i].txQuality = RF_CH_QUALITY_INIT;
+            }
+            memset(&rfModel, 0, sizeof(rfRxModel_t));
+            rfModel.offsetHits[RF_RX_OFFSET_DEFAULT] = 1;
+            memset(&rfPa, 0, sizeof(rfPaCtrl_t));
+            rfPa.level = RF_PA_UNSET;
+            for(uint8_t i = 0; i < RF_LAT_CMDS; i++) {
+                rfLat[i].first.clear();
+                rfLat[i].last.clear();
+                rfLat[i].payload.clear();
+                rfLat[i].retransmits.clear();
+            }
+            memset(&rfLatReq, 0, sizeof(rfLatReq_t));
+            memset(rfWin, 0, sizeof(rfWin));
+            memset(&rfDup, 0, sizeof(rfRxDup_t));
+            memset(poll, 0, sizeof(poll));
+            setPollPeriod(POLL_INFO,  POLL_INFO_SEC);
+            setPollPeriod(POLL_LIMIT, POLL_LIMIT_SEC);
+            setPollPeriod(POLL_LIVE,  POLL_LIVE_SEC);
+            memset(&refresh, 0, sizeof(ivRefresh_t));
+            refresh.age.clear();
+            memset(&rfRetr, 0, sizeof(rfRetrCtrl_t));
         }
 
         ~Inverter() {
             // TODO: cleanup
         }
 
-        template <typename T>
-        void enqueCommand(uint8_t cmd) {
-           _commandQueue.push(std::make_shared<T>(cmd));
-           DPRINT_IVID(DBG_INFO, id);
-           DBGPRINT(F("enqueCommand: 0x"));
-           DBGHEXLN(cmd);
+        void enqueCommand(uint8_t cmd, uint8_t prio = CMD_PRIO_NORMAL) {
+            if(!cmdQueue.push(CMD_TX_INFO, cmd, 0, prio))
+                return; // already pending or queue full
+            DPRINT_IVID(DBG_INFO, id);
+            DBGPRINT(F("enqueCommand: 0x"));
+            DBGHEXLN(cmd);
         }
 
         void setQueuedCmdFinished() {
-            if (!_commandQueue.empty()) {
-                // Will destroy CommandAbstract Class Object (?)
-                _commandQueue.pop();
-            }
+            cmdQueue.pop();
         }
 
         void clearCmdQueue() {
             DPRINTLN(DBG_INFO, F("clearCmdQueue"));
-            while (!_commandQueue.empty()) {
-                // Will destroy CommandAbstract Class Object (?)
-                _commandQueue.pop();
-            }
+            cmdQueue.clear();
         }
 
+        // queued commands (e.g. alarms, read back of the power limit) first,
+        // then the most overdue command of the polling schedule
         uint8_t getQueuedCmd() {
-            if (_commandQueue.empty()) {
-                if (ivGen != IV_MI) {
-                    if (getFwVersion() == 0)
-                        enqueCommand<InfoCommand>(InverterDevInform_All); // firmware version
-                    enqueCommand<InfoCommand>(RealTimeRunData_Debug);  // live data
-                } else if (ivGen == IV_MI){
-                    if (getFwVersion() == 0)
-                        enqueCommand<InfoCommand>(InverterDevInform_All); // firmware version; might not work, esp. for 1/2 ch hardware
-                    if (type == INV_TYPE_4CH) {
-                        enqueCommand<InfoCommand>(0x36);
-                    } else {
-                        enqueCommand<InfoCommand>(0x09);
-                    }
+            if (cmdQueue.empty())
+                enqueCommand(getScheduledCmd());
+            return cmdQueue.front()->cmd;
+        }
+
+        void setPollPeriod(uint8_t idx, uint32_t sec) {
+            if(idx < POLL_CMDS)
+                poll[idx].periodMs = sec * 1000;
+        }
+
+        uint8_t getScheduledCmd() {
+            uint32_t now = millis();
+            uint8_t next = POLL_LIVE;
+            int32_t maxOverdue = -1;
+            for(uint8_t i = 0; i < POLL_CMDS; i++) {
+                if((POLL_LIMIT == i) && !isConnected)
+                    continue; // not identified yet
+                int32_t overdue = (int32_t)(now - poll[i].dueMs);
+                if(overdue > maxOverdue) {
+                    maxOverdue = overdue;
+                    next = i;
                 }
+            }
+
+            // unknown values are requested again in the next round
+            bool unknown = ((POLL_INFO == next) && (0 == getFwVersion()))
+                || ((POLL_LIMIT == next) && (0xffff == actPowerLimit));
+            poll[next].dueMs = now + (unknown ? 0 : poll[next].periodMs);
 
-                if ((actPowerLimit == 0xffff) && isConnected)
-                    enqueCommand<InfoCommand>(SystemConfigPara); // power limit info
+            switch(next) {
+                case POLL_INFO:  return InverterDevInform_All; // firmware version; might not work for MI 1/2 ch hardware
+                case POLL_LIMIT: return SystemConfigPara;      // power limit info
+                default: break;
             }
-            return _commandQueue.front().get()->getCmd();
+            if(IV_MI == ivGen)
+                return (INV_TYPE_4CH == type) ? 0x36 : 0x09;
+            return RealTimeRunData_Debug;                      // live data
         }
 
 
@@ -197,17 +260,20 @@ class Inverter {
         }
 
         uint8_t getPosByChFld(uint8_t channel, uint8_t fieldId, record_t<> *rec) {
-            DPRINTLN(DBG_VERBOSE, F("hmInverter.h:getPosByChFld"));
+            if(NULL == rec)
+                return 0xff;
+            if(NULL != rec->idx) {
+                if((channel >= ASSIGN_IDX_CH) || (fieldId >= ASSIGN_IDX_FLD))
+                    return 0xff;
+                return rec->idx[channel * ASSIGN_IDX_FLD + fieldId];
+            }
+
             uint8_t pos = 0;
-            if(NULL != rec) {
-                for(; pos < rec->length; pos++) {
-                    if((rec->assign[pos].ch == channel) && (rec->assign[pos].fieldId == fieldId))
-                        break;
-                }
-                return (pos >= rec->length) ? 0xff : pos;
+            for(; pos < rec->length; pos++) {
+                if((rec->assign[pos].ch == channel) && (rec->assign[pos].fieldId == fieldId))
+                    break;
             }
-            else
-                return 0xff;
+            return (pos >= rec->length) ? 0xff : pos;
         }
 
         byteAssign_t *getByteAssign(uint8_t pos, record_t<> *rec) {
@@ -251,73 +317,66 @@ class Inverter {
             return mDevControlRequest;
         }
 
-        void addValue(uint8_t pos, uint8_t buf[], record_t<> *rec) {
-            DPRINTLN(DBG_VERBOSE, F("hmInverter.h:addValue"));
-            if(NULL != rec) {
-                uint8_t  ptr = rec->assign[pos].start;
-                uint8_t  end = ptr + rec->assign[pos].num;
-                uint16_t div = rec->assign[pos].div;
-
-                if(NULL != rec) {
-                    if(CMD_CALC != div) {
-                        uint32_t val = 0;
-                        do {
-                            val <<= 8;
-                            val |= buf[ptr];
-                        } while(++ptr != end);
-                        if (FLD_T == rec->assign[pos].fieldId) {
-                            // temperature is a signed value!
-                            rec->record[pos] = (REC_TYP)((int16_t)val) / (REC_TYP)(div);
-                        } else if (FLD_YT == rec->assign[pos].fieldId) {
-                            rec->record[pos] = ((REC_TYP)(val) / (REC_TYP)(div)) + ((REC_TYP)config->yieldCor[rec->assign[pos].ch-1]);
-                        } else {
-                            if ((REC_TYP)(div) > 1)
-                                rec->record[pos] = (REC_TYP)(val) / (REC_TYP)(div);
-                            else
-                                rec->record[pos] = (REC_TYP)(val);
-                        }
-                    }
-                }
+        // decodes all values of the record, buf: byte array or FragmentReader
+        template <class T>
+        void addValues(const T &buf, record_t<> *rec) {
+            if(NULL == rec) {
+                DPRINTLN(DBG_ERROR, F("addValues: assignment not found"));
+                return;
+            }
+            // generated decoder of the table, the interpreter for other tables
+            if(!assignDecoder::decode(rec->assign, rec, buf, config->yieldCor)) {
+                for(uint8_t pos = 0; pos < rec->length; pos++)
+                    decodeValue(pos, buf, rec);
+            }
+            evalRecord(rec);
+        }
 
-                if(rec == &recordMeas) {
-                    DPRINTLN(DBG_VERBOSE, "add real time");
+        // table interpreter, decodes a single value
+        template <class T>
+        void decodeValue(uint8_t pos, const T &buf, record_t<> *rec) {
+            DPRINTLN(DBG_VERBOSE, F("hmInverter.h:decodeValue"));
+            assignDecoder::interpret(rec, pos, buf, config->yieldCor);
+        }
 
-                    // get last alarm message index and save it in the inverter object
-                    if (getPosByChFld(0, FLD_EVT, rec) == pos){
-                        if (alarmMesIndex < rec->record[pos]){
-                            alarmMesIndex = rec->record[pos];
-                            //enqueCommand<InfoCommand>(AlarmUpdate); // What is the function of AlarmUpdate?
+        // takes over the values of interest of a decoded record
+        void evalRecord(record_t<> *rec) {
+            if(rec == &recordMeas) {
+                DPRINTLN(DBG_VERBOSE, "add real time");
 
-                            DPRINT(DBG_INFO, "alarm ID incremented to ");
-                            DBGPRINTLN(String(alarmMesIndex));
-                            enqueCommand<InfoCommand>(AlarmData);
-                        }
-                    }
-                }
-                else if (rec->assign == InfoAssignment) {
-                    DPRINTLN(DBG_DEBUG, "add info");
-                    // eg. fw version ...
-                    isConnected = true;
-                }
-                else if (rec->assign == SystemConfigParaAssignment) {
-                    DPRINTLN(DBG_DEBUG, "add config");
-                    if (getPosByChFld(0, FLD_ACT_ACTIVE_PWR_LIMIT, rec) == pos){
-                        actPowerLimit = rec->record[pos];
-                        DPRINT(DBG_DEBUG, F("Inverter actual power limit: "));
-                        DPRINTLN(DBG_DEBUG, String(actPowerLimit, 1));
-                    }
+                // get last alarm message index and save it in the inverter object
+                uint8_t pos = getPosByChFld(CH0, FLD_EVT, rec);
+                if ((0xff != pos) && (alarmMesIndex < rec->record[pos])) {
+                    alarmMesIndex = ah::toInt(rec->record[pos]);
+                    //enqueCommand(AlarmUpdate); // What is the function of AlarmUpdate?
+
+                    DPRINT(DBG_INFO, "alarm ID incremented to ");
+                    DBGPRINTLN(String(alarmMesIndex));
+                    enqueCommand(AlarmData, CMD_PRIO_HIGH);
                 }
-                else if (rec->assign == AlarmDataAssignment) {
-                    DPRINTLN(DBG_DEBUG, "add alarm");
-                    //if (getPosByChFld(0, FLD_LAST_ALARM_CODE, rec) == pos){
-                    //    lastAlarmMsg = getAlarmStr(rec->record[pos]);
-                    //}
+            }
+            else if (rec->assign == InfoAssignment) {
+                DPRINTLN(DBG_DEBUG, "add info");
+                // eg. fw version ...
+                isConnected = true;
+            }
+            else if (rec->assign == SystemConfigParaAssignment) {
+                DPRINTLN(DBG_DEBUG, "add config");
+                uint8_t pos = getPosByChFld(CH0, FLD_ACT_ACTIVE_PWR_LIMIT, rec);
+                if (0xff != pos) {
+                    actPowerLimit = ah::toFloat(rec->record[pos]);
+                    DPRINT(DBG_DEBUG, F("Inverter actual power limit: "));
+                    DPRINTLN(DBG_DEBUG, String(actPowerLimit, 1));
                 }
-                else
-                    DPRINTLN(DBG_WARN, F("add with unknown assginment"));
+            }
+            else if (rec->assign == AlarmDataAssignment) {
+                DPRINTLN(DBG_DEBUG, "add alarm");
+                //if (getPosByChFld(0, FLD_LAST_ALARM_CODE, rec) == pos){
+                //    lastAlarmMsg = getAlarmStr(rec->record[pos]);
+                //}
             }
             else
-                DPRINTLN(DBG_ERROR, F("addValue: assignment not found with cmd 0x"));
+                DPRINTLN(DBG_WARN, F("add with unknown assginment"));
         }
 
         /*inline REC_TYP getPowerLimit(void) {
@@ -331,24 +390,15 @@ class Inverter {
                 return false;
             if(pos > rec->length)
                 return false;
-            rec->record[pos] = val;
+            rec->set(pos, val);
             return true;
         }
 
         REC_TYP getChannelFieldValue(uint8_t channel, uint8_t fieldId, record_t<> *rec) {
-            uint8_t pos = 0;
-            if(NULL != rec) {
-                for(; pos < rec->length; pos++) {
-                    if((rec->assign[pos].ch == channel) && (rec->assign[pos].fieldId == fieldId))
-                        break;
-                }
-                if(pos >= rec->length)
-                    return 0;
-
-                return rec->record[pos];
-            }
-            else
+            uint8_t pos = getPosByChFld(channel, fieldId, rec);
+            if(0xff == pos)
                 return 0;
+            return getValue(pos, rec);
         }
 
         REC_TYP getValue(uint8_t pos, record_t<> *rec) {
@@ -357,18 +407,24 @@ class Inverter {
                 return 0;
             if(pos > rec->length)
                 return 0;
+            if((rec->calcMask & (1ULL << pos)) && (rec->calcGen[pos] != rec->gen))
+                calculate(pos, rec);
             return rec->record[pos];
         }
 
-        void doCalculations() {
-            DPRINTLN(DBG_VERBOSE, F("hmInverter.h:doCalculations"));
-            record_t<> *rec = getRecordStruct(RealTimeRunData_Debug);
-            for(uint8_t i = 0; i < rec->length; i++) {
-                if(CMD_CALC == rec->assign[i].div) {
-                    rec->record[i] = calcFunctions<REC_TYP>[rec->assign[i].start].func(this, rec->assign[i].num);
-                }
-                yield();
-            }
+        // the inputs of the calculated fields changed outside of the record,
+        // e.g. the configured module power
+        void invalidateCalc(void) {
+            recordMeas.gen++;
+            recordMeas.dirty |= recordMeas.calcMask;
+        }
+
+        // evaluates a calculated field, the result stays valid until the next
+        // value of the record changes
+        void calculate(uint8_t pos, record_t<> *rec) {
+            DPRINTLN(DBG_VERBOSE, F("hmInverter.h:calculate"));
+            rec->calcGen[pos] = rec->gen; // before the call, protects against recursion
+            rec->record[pos] = calcFunctions<REC_TYP>[rec->assign[pos].start].func(this, rec->assign[pos].num);
         }
 
         bool isAvailable(uint32_t timestamp) {
@@ -395,7 +451,126 @@ class Inverter {
         uint16_t getFwVersion() {
             record_t<> *rec = getRecordStruct(InverterDevInform_All);
             uint8_t pos = getPosByChFld(CH0, FLD_FW_VERSION, rec);
-            return getValue(pos, rec);
+            return ah::toInt(getValue(pos, rec));
+        }
+
+        // latency statistics of one request, started by the payload handler
+        void startRfLatency(uint8_t cmd, bool devControl) {
+            if(devControl)
+                rfLatReq.cmd = RF_LAT_CTRL;
+            else if(RealTimeRunData_Debug == cmd)
+                rfLatReq.cmd = RF_LAT_REALTIME;
+            else if((AlarmData == cmd) || (AlarmUpdate == cmd))
+                rfLatReq.cmd = RF_LAT_ALARM;
+            else
+                rfLatReq.cmd = RF_LAT_INFO;
+            rfLatReq.txUs    = micros();
+            rfLatReq.first   = false;
+            rfLatReq.last    = false;
+            rfLatReq.running = true;
+        }
+
+        // ts: micros() of reception
+        void addRfLatency(uint32_t ts, bool lastFragment) {
+            if(!rfLatReq.running)
+                return;
+            uint32_t ms = (ts - rfLatReq.txUs) / 1000;
+            if(!rfLatReq.first) {
+                rfLatReq.first = true;
+                rfLat[rfLatReq.cmd].first.add(ms, rfLatBounds);
+            }
+            if(lastFragment && !rfLatReq.last) {
+                rfLatReq.last = true;
+                rfLat[rfLatReq.cmd].last.add(ms, rfLatBounds);
+            }
+        }
+
+        // payload is complete and crc checked
+        void finishRfLatency(uint8_t retransmits) {
+            if(!rfLatReq.running)
+                return;
+            rfLatReq.running = false;
+            rfLat[rfLatReq.cmd].payload.add((micros() - rfLatReq.txUs) / 1000, rfLatBounds);
+            rfLat[rfLatReq.cmd].retransmits.add(retransmits, rfRetrBounds);
+        }
+
+        // sets the retransmit budget of the next request from the result of
+        // the last one: a link which needed many retransmits gets more of
+        // them (at most maxRetr), an offline inverter none. Its next answer
+        // ends the offline state.
+        void updateRetrBudget(uint8_t result, uint8_t retransmits, uint8_t maxRetr) {
+            if(RF_RETR_NONE == result) {
+                if(rfRetr.noAnswer < 0xff)
+                    rfRetr.noAnswer++;
+            } else {
+                rfRetr.noAnswer = 0;
+                if(RF_RETR_PARTIAL == result)
+                    retransmits = rfRetr.budget + 1; // the budget was too small
+                uint16_t sample = (uint16_t)retransmits << 4;
+                if(!rfRetr.learned) {
+                    rfRetr.avg     = sample;
+                    rfRetr.learned = true;
+                } else
+                    rfRetr.avg = (uint16_t)(((uint32_t)rfRetr.avg * 3 + sample) >> 2);
+            }
+
+            if(rfRetr.noAnswer >= RETR_OFFLINE_REQ)
+                rfRetr.budget = 0;
+            else if(!rfRetr.learned)
+                rfRetr.budget = maxRetr;
+            else {
+                uint16_t budget = ((rfRetr.avg * 2 + 15) >> 4) + RETR_BUDGET_MIN;
+                rfRetr.budget = (budget > maxRetr) ? maxRetr : budget;
+            }
+        }
+
+        // schedules the next request after the exchange which started at startMs,
+        // targetMs is the wanted age of the data
+        void finishRefresh(bool complete, uint32_t startMs, uint32_t targetMs) {
+            uint32_t now = millis();
+            if(complete) {
+                if(0 != refresh.lastMs)
+                    refresh.age.add((now - refresh.lastMs) / 1000, refreshAgeBounds);
+                refresh.lastMs  = now;
+                refresh.backoff = 0;
+            } else if(refresh.backoff < REFRESH_BACKOFF_MAX)
+                refresh.backoff++;
+            refresh.dueMs = startMs + (targetMs << refresh.backoff);
+        }
+
+        // the next complete answer doesn't count as refresh, e.g. after night
+        void pauseRefresh(void) {
+            refresh.lastMs  = 0;
+            refresh.backoff = 0;
+        }
+
+        // [s] since the last complete answer, 0 if there was none
+        uint32_t getRefreshAge(void) {
+            return (0 == refresh.lastMs) ? 0 : ((millis() - refresh.lastMs) / 1000);
+        }
+
+        // forgets the fragments of the last request
+        void clearRxDup(void) {
+            rfDup.cnt = 0;
+            rfDup.idx = 0;
+        }
+
+        // returns true if the same fragment was already received for the
+        // running request (inverter retransmit or copy on another channel)
+        bool isRxDuplicate(uint8_t buf[], uint8_t len) {
+            uint32_t sig = ((uint32_t)buf[9] << 24) | ((uint32_t)len << 16) | ah::crc16(buf, len);
+            for(uint8_t i = 0; i < rfDup.cnt; i++) {
+                if(sig == rfDup.sig[i]) {
+                    rfDup.dupCnt++;
+                    return true;
+                }
+            }
+            rfDup.sig[rfDup.idx] = sig;
+            if(++rfDup.idx >= RX_SIG_SIZE)
+                rfDup.idx = 0;
+            if(rfDup.cnt < RX_SIG_SIZE)
+                rfDup.cnt++;
+            return false;
         }
 
         uint32_t getLastTs(record_t<> *rec) {
@@ -465,13 +640,34 @@ class Inverter {
                     break;
             }
 
+            rec->idx = (0 != rec->length) ? assignIndex::get(rec->assign, rec->length) : NULL;
+            rec->dirty    = 0;
+            rec->ref      = NULL;
+            rec->gen      = 1; // calculated fields are evaluated on the first read
+            rec->calcMask = 0;
+            rec->calcGen  = NULL;
             if(0 != rec->length) {
+                bool deadband = false;
                 rec->record = new REC_TYP[rec->length];
-                memset(rec->record, 0, sizeof(REC_TYP) * rec->length);
+                for(uint8_t i = 0; i < rec->length; i++) {
+                    rec->record[i] = 0;
+                    deadband |= (0 != fieldDeadband[rec->assign[i].fieldId]);
+                    if(CMD_CALC == rec->assign[i].div)
+                        rec->calcMask |= (1ULL << i);
+                }
+                if(0 != rec->calcMask) {
+                    rec->calcGen = new uint32_t[rec->length]();
+                }
+                if(deadband) {
+                    rec->ref = new REC_TYP[rec->length];
+                    for(uint8_t i = 0; i < rec->length; i++)
+                        rec->ref[i] = 0;
+                }
             }
         }
 
-        uint16_t parseAlarmLog(uint8_t id, uint8_t pyld[], uint8_t len, uint32_t *start, uint32_t *endTime) {
+        template <class T>
+        uint16_t parseAlarmLog(uint8_t id, const T &pyld, uint8_t len, uint32_t *start, uint32_t *endTime) {
             uint8_t startOff = 2 + id * ALARM_LOG_ENTRY_SIZE;
             if((startOff + ALARM_LOG_ENTRY_SIZE) > len)
                 return 0;
@@ -576,7 +772,6 @@ class Inverter {
             radioId.b[0] = 0x01;
         }
 
-        std::queue<std::shared_ptr<CommandAbstract>> _commandQueue;
         bool          mDevControlRequest; // true if change needed
 };
 
@@ -587,7 +782,7 @@ class Inverter {
  * The special command 0xff (CMDFF) must be used.
  */
 
-template<class T=float>
+template<class T>
 static T calcYieldTotalCh0(Inverter<> *iv, uint8_t arg0) {
     DPRINTLN(DBG_VERBOSE, F("hmInverter.h:calcYieldTotalCh0"));
     if(NULL != iv) {
@@ -602,7 +797,7 @@ static T calcYieldTotalCh0(Inverter<> *iv, uint8_t arg0) {
     return 0.0;
 }
 
-template<class T=float>
+template<class T>
 static T calcYieldDayCh0(Inverter<> *iv, uint8_t arg0) {
     DPRINTLN(DBG_VERBOSE, F("hmInverter.h:calcYieldDayCh0"));
     if(NULL != iv) {
@@ -617,21 +812,18 @@ static T calcYieldDayCh0(Inverter<> *iv, uint8_t arg0) {
     return 0.0;
 }
 
-template<class T=float>
+template<class T>
 static T calcUdcCh(Inverter<> *iv, uint8_t arg0) {
     DPRINTLN(DBG_VERBOSE, F("hmInverter.h:calcUdcCh"));
     // arg0 = channel of source
     record_t<> *rec = iv->getRecordStruct(RealTimeRunData_Debug);
-    for(uint8_t i = 0; i < rec->length; i++) {
-        if((FLD_UDC == rec->assign[i].fieldId) && (arg0 == rec->assign[i].ch)) {
-            return iv->getValue(i, rec);
-        }
-    }
-
-    return 0.0;
+    uint8_t pos = iv->getPosByChFld(arg0, FLD_UDC, rec);
+    if(0xff == pos)
+        return 0.0;
+    return iv->getValue(pos, rec);
 }
 
-template<class T=float>
+template<class T>
 static T calcPowerDcCh0(Inverter<> *iv, uint8_t arg0) {
     DPRINTLN(DBG_VERBOSE, F("hmInverter.h:calcPowerDcCh0"));
     if(NULL != iv) {
@@ -646,7 +838,7 @@ static T calcPowerDcCh0(Inverter<> *iv, uint8_t arg0) {
     return 0.0;
 }
 
-template<class T=float>
+template<class T>
 static T calcEffiencyCh0(Inverter<> *iv, uint8_t arg0) {
     DPRINTLN(DBG_VERBOSE, F("hmInverter.h:calcEfficiencyCh0"));
     if(NULL != iv) {
@@ -659,12 +851,12 @@ static T calcEffiencyCh0(Inverter<> *iv, uint8_t arg0) {
             dcPower += iv->getValue(pos, rec);
         }
         if(dcPower > 0)
-            return acPower / dcPower * 100.0f;
+            return acPower / dcPower * (T)100;
     }
     return 0.0;
 }
 
-template<class T=float>
+template<class T>
 static T calcIrradiation(Inverter<> *iv, uint8_t arg0) {
     DPRINTLN(DBG_VERBOSE, F("hmInverter.h:calcIrradiation"));
     // arg0 = channel
@@ -672,7 +864,7 @@ static T calcIrradiation(Inverter<> *iv, uint8_t arg0) {
         record_t<> *rec = iv->getRecordStruct(RealTimeRunData_Debug);
         uint8_t pos = iv->getPosByChFld(arg0, FLD_PDC, rec);
         if(iv->config->chMaxPwr[arg0-1] > 0)
-            return iv->getValue(pos, rec) / iv->config->chMaxPwr[arg0-1] * 100.0f;
+            return iv->getValue(pos, rec) / (T)iv->config->chMaxPwr[arg0-1] * (T)100;
     }
     return 0.0;
 }
@@ -9,6 +9,8 @@
 #include "../utils/dbg.h"
 #include "../utils/crc.h"
 #include "../config/config.h"
+#include "fragmentPool.h"
+#include "payload.h"
 #include <Arduino.h>
 
 typedef struct {
@@ -16,59 +18,28 @@ typedef struct {
     uint8_t txId;
     uint8_t invId;
     uint32_t ts;
-    uint8_t data[MAX_PAYLOAD_ENTRIES][MAX_RF_PAYLOAD_SIZE];
-    uint8_t len[MAX_PAYLOAD_ENTRIES];
+    uint8_t len[MAX_PAYLOAD_ENTRIES];   // data is kept in the fragment pool
     bool complete;
     uint8_t maxPackId;
     bool lastFound;
     uint8_t retransmits;
     bool requested;
     bool gotFragment;
+    uint16_t crc;       // running crc16 over the contiguous fragments
+    uint16_t crcRcv;    // crc16 of the payload, from the last fragment
+    uint8_t crcIdx;     // number of fragments folded into crc
 } invPayload_t;
 
 
-typedef std::function<void(uint8_t)> payloadListenerType;
-typedef std::function<void(uint16_t alarmCode, uint32_t start, uint32_t end)> alarmListenerType;
-
-
 template<class HMSYSTEM>
-class HmPayload {
-    public:
-        HmPayload() {}
-
-        void setup(IApp *app, HMSYSTEM *sys, statistics_t *stat, uint8_t maxRetransmits, uint32_t *timestamp) {
-            mApp        = app;
-            mSys        = sys;
-            mStat       = stat;
-            mMaxRetrans = maxRetransmits;
-            mTimestamp  = timestamp;
-            for(uint8_t i = 0; i < MAX_NUM_INVERTERS; i++) {
-                reset(i);
-            }
-            mSerialDebug  = false;
-            mHighPrioIv   = NULL;
-            mCbAlarm      = NULL;
-            mCbPayload    = NULL;
-        }
-
-        void enableSerialDebug(bool enable) {
-            mSerialDebug = enable;
-        }
+class HmPayload : public Payload<HMSYSTEM, HmPayload<HMSYSTEM>, invPayload_t> {
+    typedef Payload<HMSYSTEM, HmPayload<HMSYSTEM>, invPayload_t> Base;
+    friend Base;
 
-        void addPayloadListener(payloadListenerType cb) {
-            mCbPayload = cb;
-        }
-
-        void addAlarmListener(alarmListenerType cb) {
-            mCbAlarm = cb;
-        }
+    public:
+        static const uint8_t IV_GEN = IV_HM;
 
-        void loop() {
-            if (NULL != mHighPrioIv) {
-                ivSend(mHighPrioIv, true);
-                mHighPrioIv = NULL;
-            }
-        }
+        HmPayload() {}
 
         void zeroYieldDay(Inverter<> *iv) {
             DPRINTLN(DBG_DEBUG, F("zeroYieldDay"));
@@ -96,69 +67,7 @@ class HmPayload {
                 }
             }
 
-            notify(RealTimeRunData_Debug);
-        }
-
-        void ivSendHighPrio(Inverter<> *iv) {
-            mHighPrioIv = iv;
-        }
-
-        void ivSend(Inverter<> *iv, bool highPrio = false) {
-            if(!highPrio) {
-                if (mPayload[iv->id].requested) {
-                    if (!mPayload[iv->id].complete)
-                        process(false); // no retransmit
-
-                    if (!mPayload[iv->id].complete) {
-                        if (mSerialDebug)
-                            DPRINT_IVID(DBG_INFO, iv->id);
-                        if (MAX_PAYLOAD_ENTRIES == mPayload[iv->id].maxPackId) {
-                            mStat->rxFailNoAnser++; // got nothing
-                            if (mSerialDebug)
-                                DBGPRINTLN(F("enqueued cmd failed/timeout"));
-                        } else {
-                            mStat->rxFail++; // got fragments but not complete response
-                            if (mSerialDebug) {
-                                DBGPRINT(F("no complete Payload received! (retransmits: "));
-                                DBGPRINT(String(mPayload[iv->id].retransmits));
-                                DBGPRINTLN(F(")"));
-                            }
-                        }
-                        iv->setQueuedCmdFinished();  // command failed
-                    }
-                }
-            }
-
-            reset(iv->id);
-            mPayload[iv->id].requested = true;
-
-            yield();
-            if (mSerialDebug) {
-                DPRINT_IVID(DBG_INFO, iv->id);
-                DBGPRINT(F("Requesting Inv SN "));
-                DBGPRINTLN(String(iv->config->serial.u64, HEX));
-            }
-
-            if (iv->getDevControlRequest()) {
-                if (mSerialDebug) {
-                    DPRINT_IVID(DBG_INFO, iv->id);
-                    DBGPRINT(F("Devcontrol request 0x"));
-                    DBGPRINT(String(iv->devControlCmd, HEX));
-                    DBGPRINT(F(" power limit "));
-                    DBGPRINTLN(String(iv->powerLimit[0]));
-                }
-                mSys->Radio.sendControlPacket(iv->radioId.u64, iv->devControlCmd, iv->powerLimit, false);
-                mPayload[iv->id].txCmd = iv->devControlCmd;
-                //iv->clearCmdQueue();
-                //iv->enqueCommand<InfoCommand>(SystemConfigPara); // read back power limit
-            } else {
-                uint8_t cmd = iv->getQueuedCmd();
-                DPRINT_IVID(DBG_INFO, iv->id);
-                DBGPRINT(F("prepareDevInformCmd 0x"));
-                DBGHEXLN(cmd);
-                mSys->Radio.prepareDevInformCmd(iv->radioId.u64, cmd, mPayload[iv->id].ts, iv->alarmMesIndex, false);
-                mPayload[iv->id].txCmd = cmd;
-            }
+            notify(RealTimeRunData_Debug, iv);
         }
 
         void add(Inverter<> *iv, packet_t *p) {
@@ -171,26 +80,41 @@ class HmPayload {
                 } else {
                     DPRINT(DBG_DEBUG, F("PID: 0x"));
                     DPRINTLN(DBG_DEBUG, String(*pid, HEX));
-                    if ((*pid & 0x7F) < MAX_PAYLOAD_ENTRIES) {
-                        memcpy(mPayload[iv->id].data[(*pid & 0x7F) - 1], &p->packet[10], p->len - 11);
-                        mPayload[iv->id].len[(*pid & 0x7F) - 1] = p->len - 11;
+                    if (((*pid & 0x7F) < MAX_PAYLOAD_ENTRIES) && (p->len > 11) && ((p->len - 11) <= FRAG_DATA_SIZE)) {
+                        uint8_t idx = (*pid & 0x7F) - 1;
+                        uint8_t evicted;
+                        uint8_t *frag = mPool.get(iv->id, idx, &evicted);
+                        if (FRAG_POOL_FREE != evicted)
+                            evict(evicted);
+                        if ((0 != mPayload[iv->id].len[idx]) && (idx < mPayload[iv->id].crcIdx))
+                            mPayload[iv->id].crcIdx = 0; // already folded fragment changed, start over
+                        memcpy(frag, &p->packet[10], p->len - 11);
+                        mPayload[iv->id].len[idx] = p->len - 11;
                         mPayload[iv->id].gotFragment = true;
                     }
 
+                    iv->addRfLatency(p->ts, ((*pid & ALL_FRAMES) == ALL_FRAMES));
                     if ((*pid & ALL_FRAMES) == ALL_FRAMES) {
                         // Last packet
                         if (((*pid & 0x7f) > mPayload[iv->id].maxPackId) || (MAX_PAYLOAD_ENTRIES == mPayload[iv->id].maxPackId)) {
+                            // the last fragment is folded without crc16, start over only if a fragment
+                            // from the new last one on or the former last one was folded already
+                            if ((mPayload[iv->id].crcIdx >= (*pid & 0x7f)) || (mPayload[iv->id].crcIdx == mPayload[iv->id].maxPackId))
+                                mPayload[iv->id].crcIdx = 0;
                             mPayload[iv->id].maxPackId = (*pid & 0x7f);
                             if (*pid > 0x81)
                                 mPayload[iv->id].lastFound = true;
                         }
                     }
+                    foldCrc(iv->id);
                 }
             } else if (p->packet[0] == (TX_REQ_DEVCONTROL + ALL_FRAMES)) { // response from dev control command
                 DPRINTLN(DBG_DEBUG, F("Response from devcontrol request received"));
 
                 mPayload[iv->id].txId = p->packet[0];
                 iv->clearDevControlRequest();
+                iv->addRfLatency(p->ts, true);
+                iv->finishRfLatency(mPayload[iv->id].retransmits);
 
                 if ((p->packet[12] == ActivePowerContr) && (p->packet[13] == 0x00)) {
                     bool ok = true;
@@ -208,7 +132,7 @@ class HmPayload {
                     DBGPRINTLN(String(iv->powerLimit[1]));
 
                     iv->clearCmdQueue();
-                    iv->enqueCommand<InfoCommand>(SystemConfigPara); // read back power limit
+                    iv->enqueCommand(SystemConfigPara); // read back power limit
                     if(mHighPrioIv == NULL)                          // do it immediately if possible
                         mHighPrioIv = iv;
                 }
@@ -216,208 +140,239 @@ class HmPayload {
             }
         }
 
-        void process(bool retransmit) {
-            for (uint8_t id = 0; id < mSys->getNumInverters(); id++) {
-                Inverter<> *iv = mSys->getInverterByPos(id);
-                if (NULL == iv)
-                    continue; // skip to next inverter
-
-                if (IV_MI == iv->ivGen) // only process HM inverters
-                    continue; // skip to next inverter
-
-                if ((mPayload[iv->id].txId != (TX_REQ_INFO + ALL_FRAMES)) && (0 != mPayload[iv->id].txId)) {
-                    // no processing needed if txId is not 0x95
-                    mPayload[iv->id].complete = true;
-                    continue; // skip to next inverter
-                }
+    private:
+        void processIv(Inverter<> *iv, bool retransmit) {
+            if ((mPayload[iv->id].txId != (TX_REQ_INFO + ALL_FRAMES)) && (0 != mPayload[iv->id].txId)) {
+                // no processing needed if txId is not 0x95
+                mPayload[iv->id].complete = true;
+                return;
+            }
 
-                if (!mPayload[iv->id].complete) {
-                    bool crcPass, pyldComplete;
-                    crcPass = build(iv->id, &pyldComplete);
-                    if (!crcPass && !pyldComplete) { // payload not complete
-                        if ((mPayload[iv->id].requested) && (retransmit)) {
-                            if (mPayload[iv->id].retransmits < mMaxRetrans) {
-                                mPayload[iv->id].retransmits++;
-                                if (iv->devControlCmd == Restart || iv->devControlCmd == CleanState_LockAndAlarm) {
-                                    // This is required to prevent retransmissions without answer.
-                                    DPRINTLN(DBG_INFO, F("Prevent retransmit on Restart / CleanState_LockAndAlarm..."));
-                                    mPayload[iv->id].retransmits = mMaxRetrans;
-                                } else if(iv->devControlCmd == ActivePowerContr) {
+            if (!mPayload[iv->id].complete) {
+                bool crcPass, pyldComplete;
+                crcPass = build(iv->id, &pyldComplete);
+                if (!crcPass && !pyldComplete) { // payload not complete
+                    if ((mPayload[iv->id].requested) && (retransmit)) {
+                        if (mPayload[iv->id].retransmits < iv->rfRetr.budget) {
+                            mPayload[iv->id].retransmits++;
+                            if (iv->devControlCmd == Restart || iv->devControlCmd == CleanState_LockAndAlarm) {
+                                // This is required to prevent retransmissions without answer.
+                                DPRINTLN(DBG_INFO, F("Prevent retransmit on Restart / CleanState_LockAndAlarm..."));
+                                mPayload[iv->id].retransmits = iv->rfRetr.budget;
+                            } else if(iv->devControlCmd == ActivePowerContr) {
+                                DPRINT_IVID(DBG_INFO, iv->id);
+                                DPRINTLN(DBG_INFO, F("retransmit power limit"));
+                                mSys->Radio.sendControlPacket(iv, iv->devControlCmd, iv->powerLimit, true);
+                            } else {
+                                if(false == mPayload[iv->id].gotFragment) {
+                                    /*
+                                    DPRINTLN(DBG_WARN, F("nothing received: Request Complete Retransmit"));
+                                    mPayload[iv->id].txCmd = iv->getQueuedCmd();
+                                    DPRINTLN(DBG_INFO, F("(#") + String(iv->id) + F(") prepareDevInformCmd 0x") + String(mPayload[iv->id].txCmd, HEX));
+                                    mSys->Radio.prepareDevInformCmd(iv, mPayload[iv->id].txCmd, mPayload[iv->id].ts, iv->alarmMesIndex, true);
+                                    */
                                     DPRINT_IVID(DBG_INFO, iv->id);
-                                    DPRINTLN(DBG_INFO, F("retransmit power limit"));
-                                    mSys->Radio.sendControlPacket(iv->radioId.u64, iv->devControlCmd, iv->powerLimit, true);
-                                } else {
-                                    if(false == mPayload[iv->id].gotFragment) {
-                                        /*
-                                        DPRINTLN(DBG_WARN, F("nothing received: Request Complete Retransmit"));
-                                        mPayload[iv->id].txCmd = iv->getQueuedCmd();
-                                        DPRINTLN(DBG_INFO, F("(#") + String(iv->id) + F(") prepareDevInformCmd 0x") + String(mPayload[iv->id].txCmd, HEX));
-                                        mSys->Radio.prepareDevInformCmd(iv->radioId.u64, mPayload[iv->id].txCmd, mPayload[iv->id].ts, iv->alarmMesIndex, true);
-                                        */
-                                        DPRINT_IVID(DBG_INFO, iv->id);
-                                        DBGPRINTLN(F("nothing received"));
-                                        mPayload[iv->id].retransmits = mMaxRetrans;
-                                    } else {
-                                        for (uint8_t i = 0; i < (mPayload[iv->id].maxPackId - 1); i++) {
-                                            if (mPayload[iv->id].len[i] == 0) {
-                                                DPRINT_IVID(DBG_WARN, iv->id);
-                                                DBGPRINT(F("Frame "));
-                                                DBGPRINT(String(i + 1));
-                                                DBGPRINTLN(F(" missing: Request Retransmit"));
-                                                mSys->Radio.sendCmdPacket(iv->radioId.u64, TX_REQ_INFO, (SINGLE_FRAME + i), true);
-                                                break;  // only request retransmit one frame per loop
-                                            }
-                                            yield();
-                                        }
-                                    }
-                                }
+                                    DBGPRINTLN(F("nothing received"));
+                                    mPayload[iv->id].retransmits = iv->rfRetr.budget;
+                                } else
+                                    requestMissing(iv);
                             }
                         }
-                    } else if(!crcPass && pyldComplete) { // crc error on complete Payload
-                        if (mPayload[iv->id].retransmits < mMaxRetrans) {
-                            mPayload[iv->id].retransmits++;
-                            DPRINTLN(DBG_WARN, F("CRC Error: Request Complete Retransmit"));
-                            mPayload[iv->id].txCmd = iv->getQueuedCmd();
-                            DPRINT_IVID(DBG_INFO, iv->id);
-                            DBGPRINT(F("prepareDevInformCmd 0x"));
-                            DBGHEXLN(mPayload[iv->id].txCmd);
-                            mSys->Radio.prepareDevInformCmd(iv->radioId.u64, mPayload[iv->id].txCmd, mPayload[iv->id].ts, iv->alarmMesIndex, true);
-                        }
-                    } else {  // payload complete
-                        DPRINT(DBG_INFO, F("procPyld: cmd:  0x"));
+                    }
+                } else if(!crcPass && pyldComplete) { // crc error on complete Payload
+                    if (mPayload[iv->id].retransmits < iv->rfRetr.budget) {
+                        mPayload[iv->id].retransmits++;
+                        DPRINTLN(DBG_WARN, F("CRC Error: Request Complete Retransmit"));
+                        mPayload[iv->id].txCmd = iv->getQueuedCmd();
+                        DPRINT_IVID(DBG_INFO, iv->id);
+                        DBGPRINT(F("prepareDevInformCmd 0x"));
                         DBGHEXLN(mPayload[iv->id].txCmd);
-                        DPRINT(DBG_INFO, F("procPyld: txid: 0x"));
-                        DBGHEXLN(mPayload[iv->id].txId);
-                        DPRINT(DBG_DEBUG, F("procPyld: max:  "));
-                        DPRINTLN(DBG_DEBUG, String(mPayload[iv->id].maxPackId));
-                        record_t<> *rec = iv->getRecordStruct(mPayload[iv->id].txCmd);  // choose the parser
-                        mPayload[iv->id].complete = true;
-
-                        uint8_t payload[128];
-                        uint8_t payloadLen = 0;
-
-                        memset(payload, 0, 128);
-
-                        for (uint8_t i = 0; i < (mPayload[iv->id].maxPackId); i++) {
-                            memcpy(&payload[payloadLen], mPayload[iv->id].data[i], (mPayload[iv->id].len[i]));
-                            payloadLen += (mPayload[iv->id].len[i]);
-                            yield();
-                        }
-                        payloadLen -= 2;
-
-                        if (mSerialDebug) {
-                            DPRINT(DBG_INFO, F("Payload ("));
-                            DBGPRINT(String(payloadLen));
-                            DBGPRINT(F("): "));
-                            mSys->Radio.dumpBuf(payload, payloadLen);
-                        }
+                        mSys->Radio.prepareDevInformCmd(iv, mPayload[iv->id].txCmd, mPayload[iv->id].ts, iv->alarmMesIndex, true);
+                    }
+                } else {  // payload complete
+                    DPRINT(DBG_INFO, F("procPyld: cmd:  0x"));
+                    DBGHEXLN(mPayload[iv->id].txCmd);
+                    DPRINT(DBG_INFO, F("procPyld: txid: 0x"));
+                    DBGHEXLN(mPayload[iv->id].txId);
+                    DPRINT(DBG_DEBUG, F("procPyld: max:  "));
+                    DPRINTLN(DBG_DEBUG, String(mPayload[iv->id].maxPackId));
+                    record_t<> *rec = iv->getRecordStruct(mPayload[iv->id].txCmd);  // choose the parser
+                    mPayload[iv->id].complete = true;
 
-                        if (NULL == rec) {
-                            DPRINTLN(DBG_ERROR, F("record is NULL!"));
-                        } else if ((rec->pyldLen == payloadLen) || (0 == rec->pyldLen)) {
-                            if (mPayload[iv->id].txId == (TX_REQ_INFO + ALL_FRAMES))
-                                mStat->rxSuccess++;
+                    // the values are decoded directly from the fragments
+                    FragmentReader payload;
+                    for (uint8_t i = 0; i < (mPayload[iv->id].maxPackId); i++)
+                        payload.add(mPool.peek(iv->id, i), mPayload[iv->id].len[i]);
+                    payload.trim(2); // crc16
+                    uint8_t payloadLen = payload.length();
+
+                    if (mSerialDebug) {
+                        DPRINT(DBG_INFO, F("Payload ("));
+                        DBGPRINT(String(payloadLen));
+                        DBGPRINTLN(F("): "));
+                        for (uint8_t i = 0; i < payload.fragments(); i++)
+                            mSys->Radio.dumpBuf((uint8_t*)payload.fragment(i), payload.fragmentLen(i));
+                    }
 
-                            rec->ts = mPayload[iv->id].ts;
-                            for (uint8_t i = 0; i < rec->length; i++) {
-                                iv->addValue(i, payload, rec);
+                    if (NULL == rec) {
+                        DPRINTLN(DBG_ERROR, F("record is NULL!"));
+                    } else if ((rec->pyldLen == payloadLen) || (0 == rec->pyldLen)) {
+                        if (mPayload[iv->id].txId == (TX_REQ_INFO + ALL_FRAMES))
+                            mStat->rxSuccess++;
+                        iv->finishRfLatency(mPayload[iv->id].retransmits);
+
+                        rec->ts = mPayload[iv->id].ts;
+                        iv->addValues(payload, rec);
+                        yield();
+                        notify(mPayload[iv->id].txCmd, iv);
+
+                        if(AlarmData == mPayload[iv->id].txCmd) {
+                            uint8_t i = 0;
+                            uint16_t code;
+                            uint32_t start, end;
+                            while(1) {
+                                code = iv->parseAlarmLog(i++, payload, payloadLen, &start, &end);
+                                if(0 == code)
+                                    break;
+                                if (NULL != mCbAlarm)
+                                    (mCbAlarm)(code, start, end);
                                 yield();
                             }
-                            iv->doCalculations();
-                            notify(mPayload[iv->id].txCmd);
-
-                            if(AlarmData == mPayload[iv->id].txCmd) {
-                                uint8_t i = 0;
-                                uint16_t code;
-                                uint32_t start, end;
-                                while(1) {
-                                    code = iv->parseAlarmLog(i++, payload, payloadLen, &start, &end);
-                                    if(0 == code)
-                                        break;
-                                    if (NULL != mCbAlarm)
-                                        (mCbAlarm)(code, start, end);
-                                    yield();
-                                }
-                            }
-                        } else {
-                            DPRINT(DBG_ERROR, F("plausibility check failed, expected "));
-                            DBGPRINT(String(rec->pyldLen));
-                            DBGPRINTLN(F(" bytes"));
-                            mStat->rxFail++;
                         }
-
-                        iv->setQueuedCmdFinished();
+                    } else {
+                        DPRINT(DBG_ERROR, F("plausibility check failed, expected "));
+                        DBGPRINT(String(rec->pyldLen));
+                        DBGPRINTLN(F(" bytes"));
+                        mStat->rxFail++;
                     }
+
+                    mPool.release(iv->id);
+                    iv->setQueuedCmdFinished();
                 }
-                yield();
             }
         }
 
-    private:
-        void notify(uint8_t val) {
-            if(NULL != mCbPayload)
-                (mCbPayload)(val);
+        void init(uint8_t id) {
+            reset(id);
         }
 
-        void notify(uint16_t code, uint32_t start, uint32_t endTime) {
-            if (NULL != mCbAlarm)
-                (mCbAlarm)(code, start, endTime);
+        bool gotNothing(uint8_t id) {
+            return (MAX_PAYLOAD_ENTRIES == mPayload[id].maxPackId);
         }
 
-        bool build(uint8_t id, bool *complete) {
-            DPRINTLN(DBG_VERBOSE, F("build"));
-            uint16_t crc = 0xffff, crcRcv = 0x0000;
-            if (mPayload[id].maxPackId > MAX_PAYLOAD_ENTRIES)
-                mPayload[id].maxPackId = MAX_PAYLOAD_ENTRIES;
-
-            // check if all fragments are there
-            *complete = true;
-            for (uint8_t i = 0; i < mPayload[id].maxPackId; i++) {
-                if(mPayload[id].len[i] == 0)
-                    *complete = false;
-            }
-            if(!*complete)
-                return false;
+        void sendDevControl(Inverter<> *iv) {
+            mSys->Radio.sendControlPacket(iv, iv->devControlCmd, iv->powerLimit, false);
+        }
 
-            for (uint8_t i = 0; i < mPayload[id].maxPackId; i++) {
-                if (mPayload[id].len[i] > 0) {
-                    if (i == (mPayload[id].maxPackId - 1)) {
-                        crc = ah::crc16(mPayload[id].data[i], mPayload[id].len[i] - 2, crc);
-                        crcRcv = (mPayload[id].data[i][mPayload[id].len[i] - 2] << 8) | (mPayload[id].data[i][mPayload[id].len[i] - 1]);
-                    } else
-                        crc = ah::crc16(mPayload[id].data[i], mPayload[id].len[i], crc);
+        void sendInfo(Inverter<> *iv) {
+            uint8_t cmd = iv->getQueuedCmd();
+            DPRINT_IVID(DBG_INFO, iv->id);
+            DBGPRINT(F("prepareDevInformCmd 0x"));
+            DBGHEXLN(cmd);
+            iv->startRfLatency(cmd, false);
+            mSys->Radio.prepareDevInformCmd(iv, cmd, mPayload[iv->id].ts, iv->alarmMesIndex, false);
+            mPayload[iv->id].txCmd = cmd;
+        }
+
+        // requests all missing fragments in one burst, the answers are
+        // collected in one listen window
+        void requestMissing(Inverter<> *iv) {
+            invPayload_t *pyld = &mPayload[iv->id];
+            uint8_t frames = pyld->maxPackId - 1; // fragments before the last one
+            bool all = true;
+            if (MAX_PAYLOAD_ENTRIES == pyld->maxPackId) { // last fragment not received
+                record_t<> *rec = iv->getRecordStruct(pyld->txCmd);
+                if ((NULL != rec) && (0 != rec->pyldLen))
+                    frames = (rec->pyldLen + 2 + 15) / 16; // incl. crc16, 16 bytes per fragment
+                else
+                    all = false; // number of fragments unknown, only request the first missing
+            }
+            if (frames > MAX_PAYLOAD_ENTRIES)
+                frames = MAX_PAYLOAD_ENTRIES;
+
+            uint8_t pid[MAX_PAYLOAD_ENTRIES];
+            uint8_t cnt = 0;
+            for (uint8_t i = 0; i < frames; i++) {
+                if (pyld->len[i] == 0) {
+                    DPRINT_IVID(DBG_WARN, iv->id);
+                    DBGPRINT(F("Frame "));
+                    DBGPRINT(String(i + 1));
+                    DBGPRINTLN(F(" missing: Request Retransmit"));
+                    pid[cnt++] = SINGLE_FRAME + i;
+                    if (!all)
+                        break;
                 }
-                yield();
             }
+            if (0 != cnt)
+                mSys->Radio.sendCmdBurst(iv, TX_REQ_INFO, pid, cnt);
+        }
+
+        // advances the crc16 over all fragments which follow the already
+        // folded ones without a gap, the last fragment ends with the crc16
+        void foldCrc(uint8_t id) {
+            invPayload_t *pyld = &mPayload[id];
+            if (0 == pyld->crcIdx)
+                pyld->crc = 0xffff;
+            if (pyld->maxPackId > MAX_PAYLOAD_ENTRIES)
+                pyld->maxPackId = MAX_PAYLOAD_ENTRIES;
+            while ((pyld->crcIdx < pyld->maxPackId) && (0 != pyld->len[pyld->crcIdx])) {
+                uint8_t i = pyld->crcIdx;
+                if (i == (pyld->maxPackId - 1)) {
+                    if (pyld->len[i] < 2)
+                        return;
+                    uint8_t *data = mPool.peek(id, i);
+                    pyld->crc    = ah::crc16(data, pyld->len[i] - 2, pyld->crc);
+                    pyld->crcRcv = (data[pyld->len[i] - 2] << 8) | (data[pyld->len[i] - 1]);
+                } else
+                    pyld->crc = ah::crc16(mPool.peek(id, i), pyld->len[i], pyld->crc);
+                pyld->crcIdx++;
+            }
+        }
+
+        // the fragment buffers were taken over by another request
+        void evict(uint8_t id) {
+            memset(mPayload[id].len, 0, MAX_PAYLOAD_ENTRIES);
+            mPayload[id].crcIdx = 0;
+        }
 
-            return (crc == crcRcv) ? true : false;
+        bool build(uint8_t id, bool *complete) {
+            DPRINTLN(DBG_VERBOSE, F("build"));
+            // all fragments are there if the crc reached the last one
+            *complete = (mPayload[id].crcIdx == mPayload[id].maxPackId);
+            if(!*complete)
+                return false;
+            return (mPayload[id].crc == mPayload[id].crcRcv);
         }
 
         void reset(uint8_t id) {
             DPRINT_IVID(DBG_INFO, id);
             DBGPRINTLN(F("resetPayload"));
             memset(mPayload[id].len, 0, MAX_PAYLOAD_ENTRIES);
+            mPool.release(id);
             mPayload[id].txCmd       = 0;
             mPayload[id].gotFragment = false;
             mPayload[id].retransmits = 0;
             mPayload[id].maxPackId   = MAX_PAYLOAD_ENTRIES;
+            mPayload[id].crc         = 0xffff;
+            mPayload[id].crcRcv      = 0x0000;
+            mPayload[id].crcIdx      = 0;
             mPayload[id].lastFound   = false;
             mPayload[id].complete    = false;
             mPayload[id].requested   = false;
             mPayload[id].ts          = *mTimestamp;
         }
 
-        IApp *mApp;
-        HMSYSTEM *mSys;
-        statistics_t *mStat;
-        uint8_t mMaxRetrans;
-        uint32_t *mTimestamp;
-        invPayload_t mPayload[MAX_NUM_INVERTERS];
-        bool mSerialDebug;
-        Inverter<> *mHighPrioIv;
-
-        alarmListenerType mCbAlarm;
-        payloadListenerType mCbPayload;
+        using Base::notify;
+        using Base::mApp;
+        using Base::mSys;
+        using Base::mStat;
+        using Base::mTimestamp;
+        using Base::mPayload;
+        using Base::mSerialDebug;
+        using Base::mHighPrioIv;
+        using Base::mCbAlarm;
+
+        FragmentPool<MAX_PAYLOAD_INFLIGHT> mPool;
 };
 
 #endif /*__HM_PAYLOAD_H__*/
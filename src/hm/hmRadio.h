@@ -3,53 +3,23 @@
 // Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
 //-----------------------------------------------------------------------------
 
-#ifndef __RADIO_H__
-#define __RADIO_H__
+#ifndef __HM_RADIO_H__
+#define __HM_RADIO_H__
 
 #include "../utils/dbg.h"
 #include <RF24.h>
-#include "../utils/crc.h"
-#include "../config/config.h"
+#include "radio.h"
 #include "SPI.h"
 
 #define SPI_SPEED           1000000
 
-#define RF_CHANNELS         5
-
-#define TX_REQ_INFO         0x15
-#define TX_REQ_DEVCONTROL   0x51
-#define ALL_FRAMES          0x80
-#define SINGLE_FRAME        0x81
-
 const char* const rf24AmpPowerNames[] = {"MIN", "LOW", "HIGH", "MAX"};
 
-
-//-----------------------------------------------------------------------------
-// MACROS
-//-----------------------------------------------------------------------------
-#define CP_U32_LittleEndian(buf, v) ({ \
-    uint8_t *b = buf; \
-    b[0] = ((v >> 24) & 0xff); \
-    b[1] = ((v >> 16) & 0xff); \
-    b[2] = ((v >>  8) & 0xff); \
-    b[3] = ((v      ) & 0xff); \
-})
-
-#define CP_U32_BigEndian(buf, v) ({ \
-    uint8_t *b = buf; \
-    b[3] = ((v >> 24) & 0xff); \
-    b[2] = ((v >> 16) & 0xff); \
-    b[1] = ((v >>  8) & 0xff); \
-    b[0] = ((v      ) & 0xff); \
-})
-
-#define BIT_CNT(x)  ((x)<<3)
-
 //-----------------------------------------------------------------------------
 // HM Radio class
 //-----------------------------------------------------------------------------
 template <uint8_t IRQ_PIN = DEF_IRQ_PIN, uint8_t CE_PIN = DEF_CE_PIN, uint8_t CS_PIN = DEF_CS_PIN, uint8_t AMP_PWR = RF24_PA_LOW, uint8_t SCLK_PIN = DEF_SCLK_PIN, uint8_t MOSI_PIN = DEF_MOSI_PIN, uint8_t MISO_PIN = DEF_MISO_PIN>
-class HmRadio {
+class HmRadio : public Radio {
     public:
         HmRadio() : mNrf24(CE_PIN, CS_PIN, SPI_SPEED) {
             if(mSerialDebug) {
@@ -74,36 +44,42 @@ class HmRadio {
             mTxChIdx    = 2; // Start TX with 40
             mRxChIdx    = 0; // Start RX with 03
 
-            mSendCnt        = 0;
-            mRetransmits    = 0;
-
-            mSerialDebug    = false;
-            mIrqRcvd        = false;
+            mRxState        = RF_IDLE;
+            mTxIv           = NULL;
+            mRxOnly         = false;
+            memset(mLastSrc, 0, 4);
+            mAvoidChIdx     = RF_CHANNELS;
+            mAmpPwr         = AMP_PWR;
+            mRxWindowMs     = RF_LISTEN_WINDOW_MS;
+            mRxChDwellUs    = RF_CH_DWELL_US;
+            mTxClass        = RF_LAT_INFO;
+            mRxExpFrags     = 0;
+            mRxFragMask     = 0;
+            mRxFirstUs      = 0;
+            mRxLastUs       = 0;
+            mRxComplete     = false;
+            mRxTimeout      = false;
+            mRxBurst        = false;
+            mRxWindowCnt    = 0;
+            mRxGapUs        = 0;
+            mRxGapMask      = 0;
+            mTxMicros       = 0;
+            mTxFirstMicros  = 0;
+            mPaLevel        = AMP_PWR;
         }
         ~HmRadio() {}
 
-        void setup(uint8_t ampPwr = RF24_PA_LOW, uint8_t irq = IRQ_PIN, uint8_t ce = CE_PIN, uint8_t cs = CS_PIN, uint8_t sclk = SCLK_PIN, uint8_t mosi = MOSI_PIN, uint8_t miso = MISO_PIN) {
+        // a receive only radio (rxOnly) listens all the time and may share the SPI bus of another radio (spi)
+        void setup(uint8_t ampPwr = RF24_PA_LOW, uint8_t irq = IRQ_PIN, uint8_t ce = CE_PIN, uint8_t cs = CS_PIN, uint8_t sclk = SCLK_PIN, uint8_t mosi = MOSI_PIN, uint8_t miso = MISO_PIN, bool rxOnly = false, SPIClass *spi = NULL) {
             DPRINTLN(DBG_VERBOSE, F("hmRadio.h:setup"));
             pinMode(irq, INPUT_PULLUP);
+            mRxOnly = rxOnly;
 
-            uint32_t dtuSn = 0x87654321;
-            uint32_t chipID = 0; // will be filled with last 3 bytes of MAC
-            #ifdef ESP32
-            uint64_t MAC = ESP.getEfuseMac();
-            chipID = ((MAC >> 8) & 0xFF0000) | ((MAC >> 24) & 0xFF00) | ((MAC >> 40) & 0xFF);
-            #else
-            chipID = ESP.getChipId();
-            #endif
-            if(chipID) {
-                dtuSn = 0x80000000; // the first digit is an 8 for DTU production year 2022, the rest is filled with the ESP chipID in decimal
-                for(int i = 0; i < 7; i++) {
-                    dtuSn |= (chipID % 10) << (i * 4);
-                    chipID /= 10;
-                }
-            }
-            // change the byte order of the DTU serial number and append the required 0x01 at the end
-            DTU_RADIO_ID = ((uint64_t)(((dtuSn >> 24) & 0xFF) | ((dtuSn >> 8) & 0xFF00) | ((dtuSn << 8) & 0xFF0000) | ((dtuSn << 24) & 0xFF000000)) << 8) | 0x01;
+            generateDtuSn();
 
+            if(NULL != spi)
+                mSpi = spi;
+            else {
             #ifdef ESP32
                 #if CONFIG_IDF_TARGET_ESP32C3 || CONFIG_IDF_TARGET_ESP32S3
                     mSpi = new SPIClass(FSPI);
@@ -116,6 +92,7 @@ class HmRadio {
                 mSpi = new SPIClass();
                 mSpi->begin();
             #endif
+            }
             mNrf24.begin(mSpi, ce, cs);
             mNrf24.setRetries(3, 15); // 3*250us + 250us and 15 loops -> 15ms
 
@@ -130,10 +107,13 @@ class HmRadio {
 
             // enable all receiving interrupts
             mNrf24.maskIRQ(false, false, false);
+            mRxHopMicros = micros();
 
             DPRINT(DBG_INFO, F("RF24 Amp Pwr: RF24_PA_"));
-            DPRINTLN(DBG_INFO, String(rf24AmpPowerNames[ampPwr]));
-            mNrf24.setPALevel(ampPwr & 0x03);
+            DPRINTLN(DBG_INFO, String(rf24AmpPowerNames[ampPwr & 0x03]));
+            mAmpPwr  = ampPwr & 0x03;
+            mPaLevel = mAmpPwr;
+            mNrf24.setPALevel(mPaLevel);
 
             if(mNrf24.isChipConnected()) {
                 DPRINTLN(DBG_INFO, F("Radio Config:"));
@@ -143,140 +123,406 @@ class HmRadio {
                 DPRINTLN(DBG_WARN, F("WARNING! your NRF24 module can't be reached, check the wiring"));
         }
 
+        // non blocking, returns true once per finished listen window
         bool loop(void) {
-            if (!mIrqRcvd)
-                return false; // nothing to do
-            mIrqRcvd = false;
-            bool tx_ok, tx_fail, rx_ready;
-            mNrf24.whatHappened(tx_ok, tx_fail, rx_ready);  // resets the IRQ pin to HIGH
-            mNrf24.flush_tx();                              // empty TX FIFO
-
-            // start listening
-            mNrf24.setChannel(mRfChLst[mRxChIdx]);
-            mNrf24.startListening();
+            if(mRxOnly)
+                return loopRxOnly();
+
+            switch(mRxState) {
+                case RF_IDLE:
+                case RF_TX_PENDING:
+                    if (!mIrqRcvd)
+                        return false; // nothing to do
+                    mIrqRcvd = false;
+                    if(RF_IDLE == mRxState)
+                        mTxIv = NULL; // not caused by a request, don't count statistics
+                    if((RF_TX_PENDING == mRxState) && !isLastOfBurst())
+                        startBurstGap();
+                    else
+                        startRx();
+                    break;
+
+                case RF_BURST_GAP:
+                    if (mIrqRcvd) {
+                        mIrqRcvd = false;
+                        getReceived();
+                    }
+                    // answer to the last request received or overdue
+                    if ((mRxFragMask != mRxGapMask) || ((micros() - mTxMicros) >= mRxGapUs))
+                        sendBurstNext();
+                    break;
 
-            uint32_t startMicros = micros();
-            uint32_t loopMillis = millis();
-            while (millis()-loopMillis < 400) {
-                while (micros()-startMicros < 5110) {  // listen (4088us or?) 5110us to each channel
+                case RF_LISTEN:
                     if (mIrqRcvd) {
                         mIrqRcvd = false;
-                        if (getReceived()) {        // everything received
-                            return true;
+                        if (getReceived()) { // everything received
+                            mRxState = RF_DONE;
+                            break;
                         }
                     }
-                    yield();
-                }
-                // switch to next RX channel
-                startMicros = micros();
-                if(++mRxChIdx >= RF_CHANNELS)
-                    mRxChIdx = 0;
-                mNrf24.setChannel(mRfChLst[mRxChIdx]);
-                yield();
+                    if ((millis() - mRxStartMillis) >= mRxWindowMs) {
+                        mRxState   = RF_DONE; // not finished but time is over
+                        mRxTimeout = true;
+                        break;
+                    }
+                    if ((micros() - mRxHopMicros) >= mRxDwellUs) {
+                        // switch to next RX channel
+                        mRxHopMicros = micros();
+                        mRxDwellUs   = mRxChDwellUs;
+                        closeDwell();
+                        if(++mRxHopIdx >= RF_CHANNELS)
+                            mRxHopIdx = 0;
+                        mRxChIdx = mRxOrder[mRxHopIdx];
+                        mNrf24.setChannel(mRfChLst[mRxChIdx]);
+                    }
+                    break;
+
+                default:
+                    break;
+            }
+
+            if (RF_DONE == mRxState) {
+                closeRx();
+                mRxState = RF_IDLE;
+                return true;
             }
-            // not finished but time is over
-            return true;
+            return false;
+        }
+
+        // ends the listen window if another radio received the last fragment
+        // of the inverter the request was sent to
+        void endRx(const uint8_t src[]) {
+            if((RF_LISTEN != mRxState) || mRxBurst) // a burst needs all fragments
+                return;
+            if(NULL == mTxIv)
+                return;
+            if((mTxIv->config->serial.b[3] == src[0])
+                && (mTxIv->config->serial.b[2] == src[1])
+                && (mTxIv->config->serial.b[1] == src[2])
+                && (mTxIv->config->serial.b[0] == src[3]))
+                mRxState = RF_DONE;
+        }
+
+        // source address of the last fragment which was reported by loop()
+        const uint8_t *getLastSrc(void) {
+            return mLastSrc;
+        }
+
+        uint8_t getRxChIdx(void) {
+            return mRxChIdx;
+        }
+
+        // channel which is not used by a receive only radio
+        void setAvoidChIdx(uint8_t idx) {
+            mAvoidChIdx = idx;
+        }
+
+        SPIClass *getSpi(void) {
+            return mSpi;
         }
 
-        void handleIntr(void) {
-            mIrqRcvd = true;
+        bool isBusy(void) {
+            return (RF_IDLE != mRxState);
         }
 
         bool isChipConnected(void) {
             //DPRINTLN(DBG_VERBOSE, F("hmRadio.h:isChipConnected"));
             return mNrf24.isChipConnected();
         }
-        void enableDebug() {
-            mSerialDebug = true;
+
+        uint8_t getDataRate(void) {
+            if(!mNrf24.isChipConnected())
+                return 3; // unkown
+            return mNrf24.getDataRate();
         }
 
-        void sendControlPacket(uint64_t invId, uint8_t cmd, uint16_t *data, bool isRetransmit, bool isNoMI = true) {
-            DPRINT(DBG_INFO, F("sendControlPacket cmd: 0x"));
-            DBGHEXLN(cmd);
-            initPacket(invId, TX_REQ_DEVCONTROL, SINGLE_FRAME);
-            uint8_t cnt = 10;
-            if (isNoMI) {
-                mTxBuf[cnt++] = cmd; // cmd -> 0 on, 1 off, 2 restart, 11 active power, 12 reactive power, 13 power factor
-                mTxBuf[cnt++] = 0x00;
-                if(cmd >= ActivePowerContr && cmd <= PFSet) { // ActivePowerContr, ReactivePowerContr, PFSet
-                    mTxBuf[cnt++] = ((data[0] * 10) >> 8) & 0xff; // power limit
-                    mTxBuf[cnt++] = ((data[0] * 10)     ) & 0xff; // power limit
-                    mTxBuf[cnt++] = ((data[1]     ) >> 8) & 0xff; // setting for persistens handlings
-                    mTxBuf[cnt++] = ((data[1]     )     ) & 0xff; // setting for persistens handling
-                }
-            } else { //MI 2nd gen. specific
-                switch (cmd) {
-                    case TurnOn:
-                        //mTxBuf[0] = 0x50;
-                        mTxBuf[9] = 0x55;
-                        mTxBuf[10] = 0xaa;
-                        break;
-                    case TurnOff:
-                        mTxBuf[9] = 0xaa;
-                        mTxBuf[10] = 0x55;
-                        break;
-                    case ActivePowerContr:
-                        cnt++;
-                        mTxBuf[9] = 0x5a;
-                        mTxBuf[10] = 0x5a;
-                        mTxBuf[11] = data[0]; // power limit
-                        break;
-                    default:
-                        return;
-                }
-                cnt++;
+        bool isPVariant(void) {
+            return mNrf24.isPVariant();
+        }
+
+        uint8_t getRfChannel(uint8_t idx) {
+            return mRfChLst[idx % RF_CHANNELS];
+        }
+
+    private:
+        // receive only: hop over all channels except the one the TX radio listens
+        // on, returns true if the last fragment of an answer was received
+        bool loopRxOnly(void) {
+            bool isLastPackage = false;
+            if (mIrqRcvd) {
+                mIrqRcvd = false;
+                isLastPackage = getReceived();
+            }
+            if ((micros() - mRxHopMicros) >= RF_CH_DWELL_US) {
+                mRxHopMicros = micros();
+                do {
+                    if(++mRxChIdx >= RF_CHANNELS)
+                        mRxChIdx = 0;
+                } while(mRxChIdx == mAvoidChIdx);
+                mNrf24.setChannel(mRfChLst[mRxChIdx]);
             }
-            sendPacket(invId, cnt, isRetransmit, isNoMI);
+            return isLastPackage;
         }
 
-        void prepareDevInformCmd(uint64_t invId, uint8_t cmd, uint32_t ts, uint16_t alarmMesId, bool isRetransmit, uint8_t reqfld=TX_REQ_INFO) { // might not be necessary to add additional arg.
-            if(mSerialDebug) {
-                DPRINT(DBG_DEBUG, F("prepareDevInformCmd 0x"));
-                DPRINTLN(DBG_DEBUG,String(cmd, HEX));
+        // listens on the RX channel between two requests of a burst until the
+        // answer to the last one arrived or it is overdue, the answers would
+        // get lost while the next request is sent otherwise
+        void startBurstGap(void) {
+            bool tx_ok, tx_fail, rx_ready;
+            mNrf24.whatHappened(tx_ok, tx_fail, rx_ready);  // resets the IRQ pin to HIGH
+            mNrf24.flush_tx();                              // empty TX FIFO
+
+            mRxGapUs = mTxIv->rfModel.delay + RF_CH_DWELL_US / 2;
+            if(mRxGapUs > RF_BURST_GAP_MAX_US)
+                mRxGapUs = RF_BURST_GAP_MAX_US;
+            mRxGapMask = mRxFragMask;
+
+            mNrf24.setChannel(mRfChLst[mRxChIdx]);
+            mNrf24.startListening();
+            mRxState = RF_BURST_GAP;
+        }
+
+        void startRx(void) {
+            bool tx_ok, tx_fail, rx_ready;
+            mNrf24.whatHappened(tx_ok, tx_fail, rx_ready);  // resets the IRQ pin to HIGH
+            mNrf24.flush_tx();                              // empty TX FIFO
+
+            // listen first on the predicted channel, then on the channels
+            // which delivered clearly better for this inverter, the others
+            // keep the default order. The channels listened to first collect
+            // most of the hits, so every RF_HOP_EXPLORE-th window uses the
+            // default order to keep the quality of all channels up to date
+            uint8_t predicted = mRxChIdx;
+            bool byQuality = (NULL != mTxIv) && (0 != (++mRxWindowCnt % RF_HOP_EXPLORE));
+            for(uint8_t i = 0; i < RF_CHANNELS; i++) {
+                uint8_t idx = (mRxChIdx + i) % RF_CHANNELS;
+                uint8_t j = i;
+                if(byQuality) {
+                    for(; j > 0; j--) {
+                        if((mTxIv->rfStat[mRxOrder[j-1]].rxQuality + RF_CH_QUALITY_LEAD) >= mTxIv->rfStat[idx].rxQuality)
+                            break;
+                        mRxOrder[j] = mRxOrder[j-1];
+                    }
+                }
+                mRxOrder[j] = idx;
             }
-            initPacket(invId, reqfld, ALL_FRAMES);
-            mTxBuf[10] = cmd; // cid
-            mTxBuf[11] = 0x00;
-            CP_U32_LittleEndian(&mTxBuf[12], ts);
-            if (cmd == RealTimeRunData_Debug || cmd == AlarmData ) {
-                mTxBuf[18] = (alarmMesId >> 8) & 0xff;
-                mTxBuf[19] = (alarmMesId     ) & 0xff;
+            for(uint8_t i = RF_CHANNELS - 1; i > 0; i--) {
+                if(mRxOrder[i] == predicted) {
+                    mRxOrder[i] = mRxOrder[i-1];
+                    mRxOrder[i-1] = predicted;
+                }
+            }
+            mRxHopIdx  = 0;
+            mRxChIdx   = mRxOrder[0];
+            mRxGotFrag = false;
+            mDwellHit  = false;
+
+            // stay on the predicted channel until the answer is expected
+            mRxDwellUs = mRxChDwellUs;
+            if(NULL != mTxIv) {
+                uint32_t expected = mTxIv->rfModel.delay + RF_CH_DWELL_US / 2;
+                uint32_t elapsed  = micros() - mTxMicros;
+                if(expected > (elapsed + mRxDwellUs))
+                    mRxDwellUs = expected - elapsed;
+                if(mRxDwellUs > RF_FIRST_DWELL_MAX_US)
+                    mRxDwellUs = RF_FIRST_DWELL_MAX_US;
             }
-            sendPacket(invId, 24, isRetransmit, true);
+
+            // start listening
+            mNrf24.setChannel(mRfChLst[mRxChIdx]);
+            mNrf24.startListening();
+
+            mRxStartMillis = millis();
+            mRxHopMicros   = micros();
+            mRxState       = RF_LISTEN;
         }
 
-        void sendCmdPacket(uint64_t invId, uint8_t mid, uint8_t pid, bool isRetransmit, bool appendCrc16=true) {
-            initPacket(invId, mid, pid);
-            sendPacket(invId, 10, isRetransmit, appendCrc16);
+        // end of listening on one channel
+        void closeDwell(void) {
+            if(NULL != mTxIv)
+                updateQuality(&mTxIv->rfStat[mRxChIdx].rxQuality, mDwellHit);
+            mDwellHit = false;
         }
 
-        void dumpBuf(uint8_t buf[], uint8_t len) {
-            //DPRINTLN(DBG_VERBOSE, F("hmRadio.h:dumpBuf"));
-            for(uint8_t i = 0; i < len; i++) {
-                DHEX(buf[i]);
-                DBGPRINT(" ");
+        // end of the listen window, the request was answered if any fragment arrived
+        void closeRx(void) {
+            closeDwell();
+            if(NULL != mTxIv) {
+                updateQuality(&mTxIv->rfStat[mTxChIdx].txQuality, mRxGotFrag);
+                updatePaLevel(&mTxIv->rfPa, mRxGotFrag);
+                learnWindow(&mTxIv->rfWin[mTxClass]);
             }
-            DBGPRINTLN("");
         }
 
-        uint8_t getDataRate(void) {
-            if(!mNrf24.isChipConnected())
-                return 3; // unkown
-            return mNrf24.getDataRate();
+        // learns only from complete answers, a timeout widens the window again
+        void learnWindow(rfWindow_t *win) {
+            if(mRxComplete) {
+                // from the first request of a burst, a fragment before it
+                // belongs to an older request
+                uint32_t last = 0;
+                if((int32_t)(mRxLastUs - mTxFirstMicros) > 0)
+                    last = mRxLastUs - mTxFirstMicros;
+                if(last > (RF_LISTEN_WINDOW_MS * 1000UL))
+                    last = RF_LISTEN_WINDOW_MS * 1000UL;
+                uint32_t span = mRxLastUs - mRxFirstUs;
+                if(0 == win->lastUs) {
+                    win->lastUs = last;
+                    win->spanUs = span;
+                } else {
+                    win->lastUs = win->lastUs - (win->lastUs >> 3) + (last >> 3);
+                    win->spanUs = win->spanUs - (win->spanUs >> 3) + (span >> 3);
+                }
+            } else if(mRxTimeout && (win->lastUs < (RF_LISTEN_WINDOW_MS * 500UL)))
+                win->lastUs += (win->lastUs >> 1);
         }
 
-        bool isPVariant(void) {
-            return mNrf24.isPVariant();
+        // twice the usual time to the last fragment plus one round over all channels
+        uint32_t getWindowMs(rfWindow_t *win) {
+            if(0 == win->lastUs)
+                return RF_LISTEN_WINDOW_MS;
+            uint32_t ms = (2 * win->lastUs + RF_CHANNELS * getChDwellUs(win)) / 1000;
+            if(ms < RF_WINDOW_MIN_MS)
+                return RF_WINDOW_MIN_MS;
+            return (ms > RF_LISTEN_WINDOW_MS) ? RF_LISTEN_WINDOW_MS : ms;
         }
 
-        std::queue<packet_t> mBufCtrl;
+        // long enough to receive all fragments of one answer on one channel,
+        // never shorter than the default: the answer may start on a channel
+        // which is not the predicted one
+        uint32_t getChDwellUs(rfWindow_t *win) {
+            if(0 == win->lastUs)
+                return RF_CH_DWELL_US;
+            uint32_t us = win->spanUs + RF_CH_DWELL_US / 2;
+            if(us < RF_CH_DWELL_US)
+                return RF_CH_DWELL_US;
+            return (us > RF_FIRST_DWELL_MAX_US) ? RF_FIRST_DWELL_MAX_US : us;
+        }
 
-        uint32_t mSendCnt;
-        uint32_t mRetransmits;
+        // number of fragments of the answer to mTxBuf, 0 if unknown
+        uint8_t getExpectedFragments(Inverter<> *iv) {
+            if(TX_REQ_DEVCONTROL == mTxBuf[0])
+                return 1;
+            if(TX_REQ_INFO != mTxBuf[0])
+                return 0; // MI
+            if(ALL_FRAMES != mTxBuf[9])
+                return mTxFrames; // retransmit of single fragments
+            record_t<> *rec = iv->getRecordStruct(mTxBuf[10]);
+            if((NULL == rec) || (0 == rec->pyldLen))
+                return 0;
+            return (rec->pyldLen + 2 + 15) / 16; // incl. crc16, 16 bytes per fragment
+        }
 
-        bool mSerialDebug;
+        // returns true if all expected fragments were received
+        bool trackFragment(packet_t *p) {
+            if(0 == mRxFragMask)
+                mRxFirstUs = p->ts;
+            mRxLastUs = p->ts;
+            uint8_t pid = p->packet[9] & 0x7f;
+            if((p->packet[0] == (TX_REQ_INFO + ALL_FRAMES)) && (pid > 0) && (pid <= 16))
+                mRxFragMask |= (1 << (pid - 1));
+            else
+                mRxFragMask |= 0x01;
+
+            if(0 == mRxExpFrags)
+                return false;
+            uint8_t cnt = 0;
+            for(uint16_t m = mRxFragMask; m; m >>= 1)
+                cnt += (m & 0x01);
+            return (cnt >= mRxExpFrags);
+        }
+
+        // raises the PA level quickly if requests are lost or need retransmits,
+        // lowers it step by step while all requests are answered at once.
+        // The configured level (mAmpPwr) is the maximum, it may be chosen low
+        // on purpose, e.g. for a module with a weak power supply
+        void updatePaLevel(rfPaCtrl_t *pa, bool answered) {
+            if(answered)
+                pa->answered++;
+            if(++pa->requests < RF_PA_EVAL_REQ)
+                return;
+
+            if(((pa->answered * 100) < (pa->requests * RF_PA_RAISE_PCT)) || (pa->retransmits > (pa->requests / 2))) {
+                if(pa->level < mAmpPwr)
+                    pa->level++;
+                pa->goodEvals = 0;
+            } else if((pa->answered == pa->requests) && (0 == pa->retransmits)) {
+                if(++pa->goodEvals >= RF_PA_LOWER_EVALS) {
+                    if(pa->level > RF24_PA_MIN)
+                        pa->level--;
+                    pa->goodEvals = 0;
+                }
+            } else
+                pa->goodEvals = 0;
+
+            pa->requests    = 0;
+            pa->answered    = 0;
+            pa->retransmits = 0;
+        }
+
+        inline void updateQuality(uint8_t *q, bool hit) {
+            // moving average with factor 1/8
+            int16_t diff = (hit ? 255 : 0) - *q;
+            *q += diff / 8;
+        }
+
+        void countFragment(bool crcOk) {
+            if(NULL == mTxIv)
+                return;
+            rfChStat_t *stat = &mTxIv->rfStat[mRxChIdx];
+            if(!crcOk) {
+                stat->crcFail++;
+                return;
+            }
+            stat->frames++;
+            mDwellHit = true;
+            if(!mRxGotFrag) {
+                mRxGotFrag = true;
+                uint32_t ttff = micros() - mTxMicros;
+                if(0 == stat->ttff)
+                    stat->ttff = ttff;
+                else
+                    stat->ttff = stat->ttff - (stat->ttff >> 3) + (ttff >> 3);
+                learnRxModel(&mTxIv->rfModel, ttff);
+            }
+        }
+
+        // the first fragment of an answer tells on which channel offset and
+        // how long after the request the inverter answers
+        void learnRxModel(rfRxModel_t *model, uint32_t delay) {
+            uint8_t offset = (mRxChIdx + RF_CHANNELS - mTxChIdx) % RF_CHANNELS;
+            if(0xff == model->offsetHits[offset]) {
+                for(uint8_t i = 0; i < RF_CHANNELS; i++)
+                    model->offsetHits[i] >>= 1; // age old observations
+            }
+            model->offsetHits[offset]++;
+
+            if(0 == model->delay)
+                model->delay = delay;
+            else
+                model->delay = model->delay - (model->delay >> 3) + (delay >> 3);
+        }
+
+        uint8_t getRxOffset(Inverter<> *iv) {
+            uint8_t offset = RF_RX_OFFSET_DEFAULT;
+            for(uint8_t i = 0; i < RF_CHANNELS; i++) {
+                if(iv->rfModel.offsetHits[i] > iv->rfModel.offsetHits[offset])
+                    offset = i;
+            }
+            return offset;
+        }
+
+        // next TX channel, channels which were not answered lately are skipped
+        uint8_t getNextTxChIdx(Inverter<> *iv) {
+            uint8_t idx = mTxChIdx;
+            for(uint8_t i = 0; i < RF_CHANNELS; i++) {
+                idx = (idx + 1) % RF_CHANNELS;
+                if(iv->rfStat[idx].txQuality >= RF_CH_QUALITY_MIN)
+                    return idx;
+                iv->rfStat[idx].txQuality += RF_CH_QUALITY_PROBE;
+            }
+            return (mTxChIdx + 1) % RF_CHANNELS; // all channels are bad
+        }
 
-    private:
         bool getReceived(void) {
             bool tx_ok, tx_fail, rx_ready;
             mNrf24.whatHappened(tx_ok, tx_fail, rx_ready); // resets the IRQ pin to HIGH
@@ -286,57 +532,55 @@ class HmRadio {
                 uint8_t len;
                 len = mNrf24.getDynamicPayloadSize(); // if payload size > 32, corrupt payload has been flushed
                 if (len > 0) {
-                    packet_t p;
-                    p.ch = mRfChLst[mRxChIdx];
-                    p.len = len;
-                    mNrf24.read(p.packet, len);
-                    if (p.packet[0] != 0x00) {
-                        mBufCtrl.push(p);
-                        if (p.packet[0] == (TX_REQ_INFO + ALL_FRAMES))  // response from get information command
-                            isLastPackage = (p.packet[9] > ALL_FRAMES); // > ALL_FRAMES indicates last packet received
-                        else if (p.packet[0] == ( 0x0f + ALL_FRAMES) )  // response from MI get information command
-                            isLastPackage = (p.packet[9] > 0x10);       // > 0x10 indicates last packet received
-                        else if ((p.packet[0] != 0x88) && (p.packet[0] != 0x92)) // ignore fragment number zero and MI status messages //#0 was p.packet[0] != 0x00 &&
-                            isLastPackage = true;                       // response from dev control command
+                    packet_t drop;
+                    packet_t *p = mBufCtrl.reserve(); // read directly into the ring
+                    if (NULL == p)
+                        p = &drop; // ring full (counted as overflow), fragment must be read anyway to free the FIFO
+                    p->ch = mRfChLst[mRxChIdx];
+                    p->len = len;
+                    p->ts = micros();
+                    mNrf24.read(p->packet, len);
+                    bool crcOk = (ah::crc8(p->packet, len - 1) == p->packet[len - 1]);
+                    capture(crcOk ? 0 : CAPTURE_CRC_FAIL, p->ch, p->packet, len, p->ts);
+                    countFragment(crcOk);
+                    if (crcOk && (p->packet[0] != 0x00) && (p != &drop)) { // a dropped fragment neither completes nor ends the window
+                        mBufCtrl.commit();
+                        if (p->packet[0] == (TX_REQ_INFO + ALL_FRAMES))  // response from get information command
+                            isLastPackage = (p->packet[9] > ALL_FRAMES); // > ALL_FRAMES indicates last packet received
+                        else if (p->packet[0] == ( 0x0f + ALL_FRAMES) )  // response from MI get information command
+                            isLastPackage = (p->packet[9] > 0x10);       // > 0x10 indicates last packet received
+                        else if ((p->packet[0] != 0x88) && (p->packet[0] != 0x92)) // ignore fragment number zero and MI status messages //#0 was p.packet[0] != 0x00 &&
+                            isLastPackage = true;                        // response from dev control command
+                        if (NULL != mTxIv) {
+                            if (trackFragment(p))
+                                isLastPackage = true;                    // expected number of fragments received
+                            else if (mRxBurst)
+                                isLastPackage = false;                   // the last fragment may overtake the others of a burst
+                        }
+                        if (isLastPackage)
+                            memcpy(mLastSrc, &p->packet[1], 4);
                     }
                 }
                 yield();
             }
+            if(isLastPackage)
+                mRxComplete = true;
             return isLastPackage;
         }
 
-        void initPacket(uint64_t invId, uint8_t mid, uint8_t pid) {
-            if(mSerialDebug) {
-                DPRINT(DBG_VERBOSE, F("initPacket, mid: "));
-                DHEX(mid);
-                DBGPRINT(F(" pid: "));
-                DBGHEXLN(pid);
-            }
-            memset(mTxBuf, 0, MAX_RF_PAYLOAD_SIZE);
-            mTxBuf[0] = mid; // message id
-            CP_U32_BigEndian(&mTxBuf[1], (invId  >> 8));
-            CP_U32_BigEndian(&mTxBuf[5], (DTU_RADIO_ID >> 8));
-            mTxBuf[9]  = pid;
-        }
-
-        void sendPacket(uint64_t invId, uint8_t len, bool isRetransmit, bool appendCrc16=true) {
+        void sendPacket(Inverter<> *iv, uint8_t len, bool isRetransmit, bool appendCrc16=true) {
             //DPRINTLN(DBG_VERBOSE, F("hmRadio.h:sendPacket"));
             //DPRINTLN(DBG_VERBOSE, "sent packet: #" + String(mSendCnt));
 
-            // append crc's
-            if (appendCrc16 && (len > 10)) {
-                // crc control data
-                uint16_t crc = ah::crc16(&mTxBuf[10], len - 10);
-                mTxBuf[len++] = (crc >> 8) & 0xff;
-                mTxBuf[len++] = (crc     ) & 0xff;
-            }
-            // crc over all
-            mTxBuf[len] = ah::crc8(mTxBuf, len);
-            len++;
+            len = finishPacket(len, appendCrc16);
 
-            // set TX and RX channels
-            mTxChIdx = (mTxChIdx + 1) % RF_CHANNELS;
-            mRxChIdx = (mTxChIdx + 2) % RF_CHANNELS;
+            // a new request ends a running listen window
+            if(((RF_LISTEN == mRxState) || (RF_BURST_GAP == mRxState)) && isFirstOfBurst())
+                closeRx();
+
+            // set TX and RX channels, RX hop order is adjusted in startRx()
+            mTxChIdx = getNextTxChIdx(iv);
+            mRxChIdx = (mTxChIdx + getRxOffset(iv)) % RF_CHANNELS;
 
             if(mSerialDebug) {
                 DPRINT(DBG_INFO, F("TX "));
@@ -347,19 +591,75 @@ class HmRadio {
                 dumpBuf(mTxBuf, len);
             }
 
+            if(RF_PA_UNSET == iv->rfPa.level)
+                iv->rfPa.level = mAmpPwr;
+
+            if(isFirstOfBurst()) {
+                // a burst is one request and is counted once
+                if(isRetransmit && (iv->rfPa.retransmits < 0xff))
+                    iv->rfPa.retransmits++;
+                if(isRetransmit)
+                    mRetransmits++;
+                else
+                    mSendCnt++;
+
+                // size the listen window from the learned answer timing, the
+                // fragments received between the requests of a burst count
+                mTxIv        = iv;
+                mTxClass     = iv->rfLatReq.cmd;
+                mRxWindowMs  = getWindowMs(&iv->rfWin[mTxClass]);
+                mRxChDwellUs = getChDwellUs(&iv->rfWin[mTxClass]);
+                mRxExpFrags  = getExpectedFragments(iv);
+                mRxBurst     = (mTxFrames > 1);
+                mRxFragMask  = 0;
+                mRxComplete  = false;
+                mRxTimeout   = false;
+            }
+
             mNrf24.stopListening();
+            if(iv->rfPa.level != mPaLevel) {
+                mPaLevel = iv->rfPa.level;
+                mNrf24.setPALevel(mPaLevel);
+            }
             mNrf24.setChannel(mRfChLst[mTxChIdx]);
-            mNrf24.openWritingPipe(reinterpret_cast<uint8_t*>(&invId));
+            mNrf24.openWritingPipe(reinterpret_cast<uint8_t*>(&iv->radioId.u64));
+            mTxMicros = micros();
+            if(isFirstOfBurst())
+                mTxFirstMicros = mTxMicros;
+            capture(CAPTURE_TX | (isRetransmit ? CAPTURE_RETRANSMIT : 0), mRfChLst[mTxChIdx], mTxBuf, len, mTxMicros);
             mNrf24.startWrite(mTxBuf, len, false); // false = request ACK response
-
-            if(isRetransmit)
-                mRetransmits++;
-            else
-                mSendCnt++;
+            mRxState  = RF_TX_PENDING; // listening starts with the TX interrupt
         }
 
-        volatile bool mIrqRcvd;
-        uint64_t DTU_RADIO_ID;
+        uint8_t mRxState;
+        uint32_t mRxStartMillis;
+        uint32_t mRxHopMicros;
+        uint32_t mRxDwellUs;
+        uint32_t mRxChDwellUs;  // dwell after the first channel
+        uint32_t mRxWindowMs;
+        uint8_t mTxClass;       // RF_LAT_* class of the request
+        uint8_t mRxExpFrags;    // expected fragments, 0: unknown
+        uint16_t mRxFragMask;   // received fragment numbers
+        uint32_t mRxFirstUs;
+        uint32_t mRxLastUs;
+        bool mRxComplete;
+        bool mRxTimeout;
+        bool mRxBurst;          // answers to several requests expected
+        uint32_t mRxGapUs;      // listen time after a request of a burst
+        uint16_t mRxGapMask;    // received fragments when the gap started
+        uint8_t mRxOrder[RF_CHANNELS];
+        uint8_t mRxHopIdx;
+        uint8_t mRxWindowCnt;   // listen windows, picks the ones with default hop order
+        bool mRxGotFrag;
+        bool mDwellHit;
+        Inverter<> *mTxIv;
+        uint32_t mTxMicros;      // last request
+        uint32_t mTxFirstMicros; // first request of a burst
+        bool mRxOnly;
+        uint8_t mLastSrc[4];
+        uint8_t mAvoidChIdx;
+        uint8_t mAmpPwr;  // configured PA level
+        uint8_t mPaLevel; // PA level which is set in the NRF24
 
         uint8_t mRfChLst[RF_CHANNELS];
         uint8_t mTxChIdx;
@@ -367,7 +667,6 @@ class HmRadio {
 
         SPIClass* mSpi;
         RF24 mNrf24;
-        uint8_t mTxBuf[MAX_RF_PAYLOAD_SIZE];
 };
 
-#endif /*__RADIO_H__*/
+#endif /*__HM_RADIO_H__*/
@@ -8,22 +8,93 @@
 
 #include "hmInverter.h"
 #include "hmRadio.h"
+#if defined(ENABLE_SIM_RADIO)
+#include "simRadio.h"
+#endif
 
-template <uint8_t MAX_INVERTER=3, class INVERTERTYPE=Inverter<float>>
+template <uint8_t MAX_INVERTER=3, class INVERTERTYPE=Inverter<>>
 class HmSystem {
     public:
-        HmRadio<> Radio;
+        #if defined(ENABLE_SIM_RADIO)
+        SimRadio Radio;    // simulated RF medium, no NRF24 required
+        #else
+        HmRadio<> Radio;   // transmits and listens in between
+        #endif
+        #if defined(ENABLE_RX_RADIO)
+        HmRadio<> RadioRx; // optional second NRF24, receive only
+        #endif
+        RadioCapture Capture; // records TX and RX of all radios
 
         HmSystem() {}
 
         void setup() {
             mNumInv = 0;
+            mRx2Enabled = false;
             Radio.setup();
+            Radio.setCapture(&Capture);
         }
 
-        void setup(uint8_t ampPwr, uint8_t irqPin, uint8_t cePin, uint8_t csPin, uint8_t sclkPin, uint8_t mosiPin, uint8_t misoPin) {
+        void setup(uint8_t ampPwr, uint8_t irqPin, uint8_t cePin, uint8_t csPin, uint8_t sclkPin, uint8_t mosiPin, uint8_t misoPin, uint8_t irqPin2 = DEF_PIN_OFF, uint8_t cePin2 = DEF_PIN_OFF, uint8_t csPin2 = DEF_PIN_OFF) {
             mNumInv = 0;
             Radio.setup(ampPwr, irqPin, cePin, csPin, sclkPin, mosiPin, misoPin);
+            Radio.setCapture(&Capture);
+
+            mRx2Enabled = false;
+            #if defined(ENABLE_RX_RADIO)
+            if((DEF_PIN_OFF != irqPin2) && (DEF_PIN_OFF != cePin2) && (DEF_PIN_OFF != csPin2)) {
+                DPRINTLN(DBG_INFO, F("second radio (RX only):"));
+                RadioRx.setup(ampPwr, irqPin2, cePin2, csPin2, sclkPin, mosiPin, misoPin, true, Radio.getSpi());
+                mRx2Enabled = RadioRx.isChipConnected();
+                RadioRx.setCapture(&Capture);
+            }
+            #endif
+        }
+
+        // returns true once the listen window of the TX radio is finished
+        bool loop(void) {
+            #if defined(ENABLE_RX_RADIO)
+            if(mRx2Enabled) {
+                RadioRx.setAvoidChIdx(Radio.getRxChIdx());
+                if(RadioRx.loop())
+                    Radio.endRx(RadioRx.getLastSrc()); // last fragment was received by the second radio
+            }
+            #endif
+            if(!Radio.loop())
+                return false;
+            Capture.loop(); // write to flash between the listen windows
+            return true;
+        }
+
+        // oldest received packet of all radios, stays valid until popPacket()
+        packet_t *getPacket(void) {
+            packet_t *p = Radio.mBufCtrl.peek();
+            mPktFromRx2 = false;
+            #if defined(ENABLE_RX_RADIO)
+            if(mRx2Enabled) {
+                packet_t *p2 = RadioRx.mBufCtrl.peek();
+                if((NULL != p2) && ((NULL == p) || ((int32_t)(p2->ts - p->ts) < 0))) {
+                    mPktFromRx2 = true;
+                    return p2;
+                }
+            }
+            #endif
+            return p;
+        }
+
+        void popPacket(void) {
+            #if defined(ENABLE_RX_RADIO)
+            if(mPktFromRx2) {
+                RadioRx.mBufCtrl.pop();
+                return;
+            }
+            #endif
+            Radio.mBufCtrl.pop();
+        }
+
+        void handleIntr2(void) {
+            #if defined(ENABLE_RX_RADIO)
+            RadioRx.handleIntr();
+            #endif
         }
 
         void addInverters(cfgInst_t *config) {
@@ -126,11 +197,16 @@ class HmSystem {
 
         void enableDebug() {
             Radio.enableDebug();
+            #if defined(ENABLE_RX_RADIO)
+            RadioRx.enableDebug();
+            #endif
         }
 
     private:
         INVERTERTYPE mInverter[MAX_INVERTER];
         uint8_t mNumInv;
+        bool mRx2Enabled;
+        bool mPktFromRx2;
 };
 
 #endif /*__HM_SYSTEM_H__*/
@@ -0,0 +1,145 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __IV_SCHEDULER_H__
+#define __IV_SCHEDULER_H__
+
+#include "../utils/dbg.h"
+#include "../config/config.h"
+#include "../defines.h"
+#include <Arduino.h>
+
+//-----------------------------------------------------------------------------
+// Inverter scheduler
+// moves the received fragments of the radio(s) to the payload handlers and
+// keeps the radio busy as long as an inverter is due: the next request starts
+// as soon as the previous one including its retransmits has finished. The
+// inverter which waits longest for its deadline is requested first.
+// Used by app and by the host simulation (tools/host/ivSim).
+//-----------------------------------------------------------------------------
+template<class HMSYSTEM, class HMPAYLOAD, class MIPAYLOAD>
+class IvScheduler {
+    public:
+        void setup(HMSYSTEM *sys, HMPAYLOAD *hmPayload, MIPAYLOAD *miPayload, statistics_t *stat, uint16_t *sendInterval) {
+            mSys          = sys;
+            mHmPayload    = hmPayload;
+            mMiPayload    = miPayload;
+            mStat         = stat;
+            mSendInterval = sendInterval;
+            mSerialDebug  = false;
+            mSendIv       = NULL;
+            mSendMs       = 0;
+        }
+
+        void enableSerialDebug(bool enable) {
+            mSerialDebug = enable;
+        }
+
+        // non blocking, send: the next request follows a finished exchange
+        // back to back
+        void loop(bool send) {
+            if (mSys->loop()) {
+                packet_t *p;
+                while (NULL != (p = mSys->getPacket())) {
+                    if (mSerialDebug) {
+                        DPRINT(DBG_INFO, F("RX "));
+                        DBGPRINT(String(p->len));
+                        DBGPRINT(F("B Ch"));
+                        DBGPRINT(String(p->ch));
+                        DBGPRINT(F(" | "));
+                        mSys->Radio.dumpBuf(p->packet, p->len);
+                    }
+                    Inverter<> *iv = mSys->findInverter(&p->packet[1]);
+                    if (NULL != iv) {
+                        if (iv->isRxDuplicate(p->packet, p->len))
+                            mStat->frmDup++; // already received for this request
+                        else {
+                            mStat->frmCnt++;
+                            if (IV_HM == iv->ivGen)
+                                mHmPayload->add(iv, p);
+                            else
+                                mMiPayload->add(iv, p);
+                        }
+                    }
+                    mSys->popPacket();
+                    yield();
+                }
+                mStat->rxBufOverflow  = mSys->Radio.mBufCtrl.getOverflowCnt();
+                mStat->rxBufHighWater = mSys->Radio.mBufCtrl.getHighWater();
+                #if defined(ENABLE_RX_RADIO)
+                mStat->rxBufOverflow += mSys->RadioRx.mBufCtrl.getOverflowCnt();
+                if (mSys->RadioRx.mBufCtrl.getHighWater() > mStat->rxBufHighWater)
+                    mStat->rxBufHighWater = mSys->RadioRx.mBufCtrl.getHighWater();
+                #endif
+                mHmPayload->process(true);
+                mMiPayload->process(true);
+                if (send && (NULL != mSendIv))
+                    sendNext();
+            }
+            mHmPayload->loop();
+            mMiPayload->loop();
+        }
+
+        // requests the most overdue inverter if the running exchange has
+        // finished, called every second and after each listen window
+        void sendNext(void) {
+            uint32_t now = millis();
+            if (NULL != mSendIv) {
+                if (mSys->Radio.isBusy() && ((now - mSendMs) < REFRESH_EXCHANGE_MS))
+                    return;  // exchange is running
+
+                bool complete = (IV_HM == mSendIv->ivGen) ? mHmPayload->isComplete(mSendIv) : mMiPayload->isComplete(mSendIv);
+                mSendIv->finishRefresh(complete, mSendMs, *mSendInterval * 1000UL);
+                if (mSerialDebug && (0 != mSendIv->refresh.backoff)) {
+                    DPRINT_IVID(DBG_INFO, mSendIv->id);
+                    DBGPRINT(F("no answer, next request in "));
+                    DBGPRINT(String((mSendIv->refresh.dueMs - now) / 1000));
+                    DBGPRINTLN(F("s"));
+                }
+                mSendIv = NULL;
+            }
+
+            Inverter<> *iv = NULL;
+            int32_t maxOverdue = -1;
+            for (uint8_t i = 0; i < MAX_NUM_INVERTERS; i++) {
+                Inverter<> *cur = mSys->getInverterByPos(i);
+                if ((NULL == cur) || !cur->config->enabled)
+                    continue;
+                int32_t overdue = (int32_t)(now - cur->refresh.dueMs);
+                if (overdue > maxOverdue) {
+                    maxOverdue = overdue;
+                    iv = cur;
+                }
+            }
+            if (NULL == iv)
+                return;  // all inverters are up to date
+
+            mSendIv = iv;
+            mSendMs = now;
+            if (IV_HM == iv->ivGen)
+                mHmPayload->ivSend(iv);
+            else
+                mMiPayload->ivSend(iv);
+        }
+
+        // forgets the running exchange, e.g. when the communication stops
+        // at night
+        void stop(void) {
+            mSendIv = NULL;
+        }
+
+    private:
+        HMSYSTEM *mSys;
+        HMPAYLOAD *mHmPayload;
+        MIPAYLOAD *mMiPayload;
+        statistics_t *mStat;
+        uint16_t *mSendInterval; // [s]
+        bool mSerialDebug;
+
+        Inverter<> *mSendIv;  // running exchange
+        uint32_t mSendMs;     // millis() when it was requested
+};
+
+#endif /*__IV_SCHEDULER_H__*/
@@ -10,6 +10,7 @@
 #include "../utils/dbg.h"
 #include "../utils/crc.h"
 #include "../config/config.h"
+#include "payload.h"
 #include <Arduino.h>
 
 typedef struct {
@@ -33,144 +34,19 @@ typedef struct {
 } miPayload_t;
 
 
-typedef std::function<void(uint8_t)> miPayloadListenerType;
-
-
 template<class HMSYSTEM>
-class MiPayload {
-    public:
-        MiPayload() {}
-
-        void setup(IApp *app, HMSYSTEM *sys, statistics_t *stat, uint8_t maxRetransmits, uint32_t *timestamp) {
-            mApp        = app;
-            mSys        = sys;
-            mStat       = stat;
-            mMaxRetrans = maxRetransmits;
-            mTimestamp  = timestamp;
-            for(uint8_t i = 0; i < MAX_NUM_INVERTERS; i++) {
-                reset(i, true);
-                mPayload[i].limitrequested = true;
-            }
-            mSerialDebug  = false;
-            mHighPrioIv   = NULL;
-            mCbMiPayload  = NULL;
-        }
-
-        void enableSerialDebug(bool enable) {
-            mSerialDebug = enable;
-        }
-
-        void addPayloadListener(miPayloadListenerType cb) {
-            mCbMiPayload = cb;
-        }
-
-        void addAlarmListener(alarmListenerType cb) {
-            mCbMiAlarm = cb;
-        }
-
-        void loop() {
-            if (NULL != mHighPrioIv) {
-                ivSend(mHighPrioIv, true); // for e.g. devcontrol commands
-                mHighPrioIv = NULL;
-            }
-        }
-
-        void ivSendHighPrio(Inverter<> *iv) {
-            mHighPrioIv = iv;
-        }
+class MiPayload : public Payload<HMSYSTEM, MiPayload<HMSYSTEM>, miPayload_t> {
+    typedef Payload<HMSYSTEM, MiPayload<HMSYSTEM>, miPayload_t> Base;
+    friend Base;
 
-        void ivSend(Inverter<> *iv, bool highPrio = false) {
-            if(!highPrio) {
-                if (mPayload[iv->id].requested) {
-                    if (!mPayload[iv->id].complete)
-                        process(false); // no retransmit
-
-                    if (!mPayload[iv->id].complete) {
-                        if (mSerialDebug)
-                            DPRINT_IVID(DBG_INFO, iv->id);
-                        if (!mPayload[iv->id].gotFragment) {
-                            mStat->rxFailNoAnser++; // got nothing
-                            if (mSerialDebug)
-                                DBGPRINTLN(F("enqueued cmd failed/timeout"));
-                        } else {
-                            mStat->rxFail++;        // got "fragments" (part of the required messages)
-                                                    // but no complete set of responses
-                            if (mSerialDebug) {
-                                DBGPRINT(F("no complete Payload received! (retransmits: "));
-                                DBGPRINT(String(mPayload[iv->id].retransmits));
-                                DBGPRINTLN(F(")"));
-                            }
-                        }
-                        iv->setQueuedCmdFinished(); // command failed
-                    }
-                }
-            }
-
-            reset(iv->id);
-            mPayload[iv->id].requested = true;
-
-            yield();
-            if (mSerialDebug){
-                DPRINT_IVID(DBG_INFO, iv->id);
-                DBGPRINT(F("Requesting Inv SN "));
-                DBGPRINTLN(String(iv->config->serial.u64, HEX));
-            }
-
-            if (iv->getDevControlRequest()) {
-                if (mSerialDebug) {
-                    DPRINT_IVID(DBG_INFO, iv->id);
-                    DBGPRINT(F("Devcontrol request 0x"));
-                    DHEX(iv->devControlCmd);
-                    DBGPRINT(F(" power limit "));
-                    DBGPRINTLN(String(iv->powerLimit[0]));
-                }
-                mSys->Radio.sendControlPacket(iv->radioId.u64, iv->devControlCmd, iv->powerLimit, false, false);
-                mPayload[iv->id].txCmd = iv->devControlCmd;
-                mPayload[iv->id].limitrequested = true;
-
-                iv->clearCmdQueue();
-                iv->enqueCommand<InfoCommand>(SystemConfigPara); // try to read back power limit
-            } else {
-                uint8_t cmd = iv->getQueuedCmd();
-                DPRINT_IVID(DBG_INFO, iv->id);
-                DBGPRINT(F("prepareDevInformCmd 0x"));
-                DBGHEXLN(cmd);
-                uint8_t cmd2 = cmd;
-                if ( cmd == SystemConfigPara ) { //0x05 for HM-types
-                    if (!mPayload[iv->id].limitrequested) { // only do once at startup
-                        iv->setQueuedCmdFinished();
-                        cmd = iv->getQueuedCmd();
-                    } else {
-                        mPayload[iv->id].limitrequested = false;
-                    }
-                }
-
-                if (cmd == 0x01 || cmd == SystemConfigPara ) { //0x1 and 0x05 for HM-types
-                    cmd  = 0x0f;                              // for MI, these seem to make part of the  Polling the device software and hardware version number command
-                    cmd2 = cmd == SystemConfigPara ? 0x01 : 0x00;  //perhaps we can only try to get second frame?
-                    mSys->Radio.sendCmdPacket(iv->radioId.u64, cmd, cmd2, false, false);
-                } else {
-                    //mSys->Radio.prepareDevInformCmd(iv->radioId.u64, cmd2, mPayload[iv->id].ts, iv->alarmMesIndex, false, cmd);
-                    mSys->Radio.sendCmdPacket(iv->radioId.u64, cmd, cmd2, false, false);
-                };
-
-                mPayload[iv->id].txCmd = cmd;
-                if (iv->type == INV_TYPE_1CH || iv->type == INV_TYPE_2CH) {
-                    mPayload[iv->id].dataAB[CH1] = false;
-                    mPayload[iv->id].stsAB[CH1] = false;
-                    mPayload[iv->id].dataAB[CH0] = false;
-                    mPayload[iv->id].stsAB[CH0] = false;
-                }
+    public:
+        static const uint8_t IV_GEN = IV_MI;
 
-                if (iv->type == INV_TYPE_2CH) {
-                    mPayload[iv->id].dataAB[CH2] = false;
-                    mPayload[iv->id].stsAB[CH2] = false;
-                }
-            }
-        }
+        MiPayload() {}
 
         void add(Inverter<> *iv, packet_t *p) {
             //DPRINTLN(DBG_INFO, F("MI got data [0]=") + String(p->packet[0], HEX));
+            iv->addRfLatency(p->ts, false);
             if (p->packet[0] == (0x08 + ALL_FRAMES)) { // 0x88; MI status response to 0x09
                 miStsDecode(iv, p);
             }
@@ -267,6 +143,8 @@ const byteAssign_t InfoAssignment[] = {
                     iv->setQueuedCmdFinished();
                     mPayload[iv->id].complete = true;
                     mStat->rxSuccess++;
+                    iv->addRfLatency(p->ts, true);
+                    iv->finishRfLatency(mPayload[iv->id].retransmits);
                 }
 
             } else if ( p->packet[0] == (TX_REQ_INFO + ALL_FRAMES) // response from get information command
@@ -309,6 +187,8 @@ const byteAssign_t InfoAssignment[] = {
 
                 mPayload[iv->id].txId = p->packet[0];
                 iv->clearDevControlRequest();
+                iv->addRfLatency(p->ts, true);
+                iv->finishRfLatency(mPayload[iv->id].retransmits);
 
                 if ((p->packet[9] == 0x5a) && (p->packet[10] == 0x5a)) {
                     mApp->setMqttPowerLimitAck(iv);
@@ -319,7 +199,7 @@ const byteAssign_t InfoAssignment[] = {
                     DBGPRINTLN(String(iv->powerLimit[1]));
 
                     iv->clearCmdQueue();
-                    iv->enqueCommand<InfoCommand>(SystemConfigPara); // read back power limit
+                    iv->enqueCommand(SystemConfigPara); // read back power limit
                 }
                 iv->devControlCmd = Init;
             } else {  // some other response; copied from hmPayload:process; might not be correct to do that here!!!
@@ -358,12 +238,9 @@ const byteAssign_t InfoAssignment[] = {
                         mStat->rxSuccess++;
 
                     rec->ts = mPayload[iv->id].ts;
-                    for (uint8_t i = 0; i < rec->length; i++) {
-                        iv->addValue(i, payload, rec);
-                        yield();
-                    }
-                    iv->doCalculations();
-                    notify(mPayload[iv->id].txCmd);
+                    iv->addValues(payload, rec);
+                    yield();
+                    notify(mPayload[iv->id].txCmd, iv);
 
                     if(AlarmData == mPayload[iv->id].txCmd) {
                         uint8_t i = 0;
@@ -373,8 +250,8 @@ const byteAssign_t InfoAssignment[] = {
                             code = iv->parseAlarmLog(i++, payload, payloadLen, &start, &end);
                             if(0 == code)
                                 break;
-                            if (NULL != mCbMiAlarm)
-                                (mCbMiAlarm)(code, start, end);
+                            if (NULL != mCbAlarm)
+                                (mCbAlarm)(code, start, end);
                             yield();
                         }
                     }
@@ -387,180 +264,221 @@ const byteAssign_t InfoAssignment[] = {
             }
         }
 
-        void process(bool retransmit) {
-            for (uint8_t id = 0; id < mSys->getNumInverters(); id++) {
-                Inverter<> *iv = mSys->getInverterByPos(id);
-                if (NULL == iv)
-                    continue; // skip to next inverter
-
-                if (IV_HM == iv->ivGen) // only process MI inverters
-                    continue; // skip to next inverter
-
-                if ( !mPayload[iv->id].complete &&
-                    (mPayload[iv->id].txId != (TX_REQ_INFO + ALL_FRAMES)) &&
-                    (mPayload[iv->id].txId <  (0x36 + ALL_FRAMES)) &&
-                    (mPayload[iv->id].txId >  (0x39 + ALL_FRAMES)) &&
-                    (mPayload[iv->id].txId != (0x09 + ALL_FRAMES)) &&
-                    (mPayload[iv->id].txId != (0x11 + ALL_FRAMES)) &&
-                    (mPayload[iv->id].txId != (0x88)) &&
-                    (mPayload[iv->id].txId != (0x92)) &&
-                    (mPayload[iv->id].txId != 0 )) {
-                    // no processing needed if txId is not one of 0x95, 0x88, 0x89, 0x91, 0x92 or resonse to 0x36ff
-                    mPayload[iv->id].complete = true;
-                    continue; // skip to next inverter
+    private:
+        void init(uint8_t id) {
+            reset(id, true);
+            mPayload[id].limitrequested = true;
+        }
+
+        bool gotNothing(uint8_t id) {
+            return !mPayload[id].gotFragment;
+        }
+
+        void sendDevControl(Inverter<> *iv) {
+            mSys->Radio.sendControlPacket(iv, iv->devControlCmd, iv->powerLimit, false, false);
+            mPayload[iv->id].limitrequested = true;
+
+            iv->clearCmdQueue();
+            iv->enqueCommand(SystemConfigPara); // try to read back power limit
+        }
+
+        void sendInfo(Inverter<> *iv) {
+            uint8_t cmd = iv->getQueuedCmd();
+            DPRINT_IVID(DBG_INFO, iv->id);
+            DBGPRINT(F("prepareDevInformCmd 0x"));
+            DBGHEXLN(cmd);
+            uint8_t cmd2 = cmd;
+            if ( cmd == SystemConfigPara ) { //0x05 for HM-types
+                if (!mPayload[iv->id].limitrequested) { // only do once at startup
+                    iv->setQueuedCmdFinished();
+                    cmd = iv->getQueuedCmd();
+                } else {
+                    mPayload[iv->id].limitrequested = false;
                 }
+            }
 
-                //delayed next message?
-                //mPayload[iv->id].skipfirstrepeat++;
-                /*if (mPayload[iv->id].skipfirstrepeat) {
-                    mPayload[iv->id].skipfirstrepeat = 0; //reset counter
-                    continue; // skip to next inverter
-                }*/
+            iv->startRfLatency(cmd, false);
+            if (cmd == 0x01 || cmd == SystemConfigPara ) { //0x1 and 0x05 for HM-types
+                cmd  = 0x0f;                              // for MI, these seem to make part of the  Polling the device software and hardware version number command
+                cmd2 = cmd == SystemConfigPara ? 0x01 : 0x00;  //perhaps we can only try to get second frame?
+                mSys->Radio.sendCmdPacket(iv, cmd, cmd2, false, false);
+            } else {
+                //mSys->Radio.prepareDevInformCmd(iv, cmd2, mPayload[iv->id].ts, iv->alarmMesIndex, false, cmd);
+                mSys->Radio.sendCmdPacket(iv, cmd, cmd2, false, false);
+            };
+
+            mPayload[iv->id].txCmd = cmd;
+            if (iv->type == INV_TYPE_1CH || iv->type == INV_TYPE_2CH) {
+                mPayload[iv->id].dataAB[CH1] = false;
+                mPayload[iv->id].stsAB[CH1] = false;
+                mPayload[iv->id].dataAB[CH0] = false;
+                mPayload[iv->id].stsAB[CH0] = false;
+            }
 
-                if (!mPayload[iv->id].complete) {
-                    //DPRINTLN(DBG_INFO, F("Pyld incompl code")); //info for testing only
-                    bool crcPass, pyldComplete;
-                    crcPass = build(iv->id, &pyldComplete);
-                    if (!crcPass && !pyldComplete) { // payload not complete
-                        if ((mPayload[iv->id].requested) && (retransmit)) {
-                            if (iv->devControlCmd == Restart || iv->devControlCmd == CleanState_LockAndAlarm) {
-                                // This is required to prevent retransmissions without answer.
-                                DPRINT_IVID(DBG_INFO, iv->id);
-                                DBGPRINTLN(F("Prevent retransmit on Restart / CleanState_LockAndAlarm..."));
-                                mPayload[iv->id].retransmits = mMaxRetrans;
-                            } else if(iv->devControlCmd == ActivePowerContr) {
-                                DPRINT_IVID(DBG_INFO, iv->id);
-                                DBGPRINTLN(F("retransmit power limit"));
-                                mSys->Radio.sendControlPacket(iv->radioId.u64, iv->devControlCmd, iv->powerLimit, true, false);
-                            } else {
-                                uint8_t cmd = mPayload[iv->id].txCmd;
-                                if (mPayload[iv->id].retransmits < mMaxRetrans) {
-                                    mPayload[iv->id].retransmits++;
-                                    if( !mPayload[iv->id].gotFragment ) {
-                                        DPRINT_IVID(DBG_INFO, iv->id);
-                                        DBGPRINTLN(F("nothing received"));
-                                        mPayload[iv->id].retransmits = mMaxRetrans;
-                                    } else if ( cmd == 0x0f ) {
-                                        //hard/firmware request
-                                        mSys->Radio.sendCmdPacket(iv->radioId.u64, 0x0f, 0x00, true, false);
-                                        //iv->setQueuedCmdFinished();
-                                        //cmd = iv->getQueuedCmd();
-                                    } else {
-                                        bool change = false;
-                                        if ( cmd >= 0x36 && cmd < 0x39 ) { // MI-1500 Data command
-                                            if (cmd > 0x36 && mPayload[iv->id].retransmits==1) // first request for the upper channels
+            if (iv->type == INV_TYPE_2CH) {
+                mPayload[iv->id].dataAB[CH2] = false;
+                mPayload[iv->id].stsAB[CH2] = false;
+            }
+        }
+
+        void processIv(Inverter<> *iv, bool retransmit) {
+            if ( !mPayload[iv->id].complete &&
+                (mPayload[iv->id].txId != (TX_REQ_INFO + ALL_FRAMES)) &&
+                (mPayload[iv->id].txId <  (0x36 + ALL_FRAMES)) &&
+                (mPayload[iv->id].txId >  (0x39 + ALL_FRAMES)) &&
+                (mPayload[iv->id].txId != (0x09 + ALL_FRAMES)) &&
+                (mPayload[iv->id].txId != (0x11 + ALL_FRAMES)) &&
+                (mPayload[iv->id].txId != (0x88)) &&
+                (mPayload[iv->id].txId != (0x92)) &&
+                (mPayload[iv->id].txId != 0 )) {
+                // no processing needed if txId is not one of 0x95, 0x88, 0x89, 0x91, 0x92 or resonse to 0x36ff
+                mPayload[iv->id].complete = true;
+                return;
+            }
+
+            //delayed next message?
+            //mPayload[iv->id].skipfirstrepeat++;
+            /*if (mPayload[iv->id].skipfirstrepeat) {
+                mPayload[iv->id].skipfirstrepeat = 0; //reset counter
+                continue; // skip to next inverter
+            }*/
+
+            if (!mPayload[iv->id].complete) {
+                //DPRINTLN(DBG_INFO, F("Pyld incompl code")); //info for testing only
+                bool crcPass, pyldComplete;
+                crcPass = build(iv->id, &pyldComplete);
+                if (!crcPass && !pyldComplete) { // payload not complete
+                    if ((mPayload[iv->id].requested) && (retransmit)) {
+                        if (iv->devControlCmd == Restart || iv->devControlCmd == CleanState_LockAndAlarm) {
+                            // This is required to prevent retransmissions without answer.
+                            DPRINT_IVID(DBG_INFO, iv->id);
+                            DBGPRINTLN(F("Prevent retransmit on Restart / CleanState_LockAndAlarm..."));
+                            mPayload[iv->id].retransmits = iv->rfRetr.budget;
+                        } else if(iv->devControlCmd == ActivePowerContr) {
+                            DPRINT_IVID(DBG_INFO, iv->id);
+                            DBGPRINTLN(F("retransmit power limit"));
+                            mSys->Radio.sendControlPacket(iv, iv->devControlCmd, iv->powerLimit, true, false);
+                        } else {
+                            uint8_t cmd = mPayload[iv->id].txCmd;
+                            if (mPayload[iv->id].retransmits < iv->rfRetr.budget) {
+                                mPayload[iv->id].retransmits++;
+                                if( !mPayload[iv->id].gotFragment ) {
+                                    DPRINT_IVID(DBG_INFO, iv->id);
+                                    DBGPRINTLN(F("nothing received"));
+                                    mPayload[iv->id].retransmits = iv->rfRetr.budget;
+                                } else if ( cmd == 0x0f ) {
+                                    //hard/firmware request
+                                    mSys->Radio.sendCmdPacket(iv, 0x0f, 0x00, true, false);
+                                    //iv->setQueuedCmdFinished();
+                                    //cmd = iv->getQueuedCmd();
+                                } else {
+                                    bool change = false;
+                                    if ( cmd >= 0x36 && cmd < 0x39 ) { // MI-1500 Data command
+                                        if (cmd > 0x36 && mPayload[iv->id].retransmits==1) // first request for the upper channels
+                                            change = true;
+                                    } else if ( cmd == 0x09 ) {//MI single or dual channel device
+                                        if ( mPayload[iv->id].dataAB[CH1] && iv->type == INV_TYPE_2CH  ) {
+                                            if (!mPayload[iv->id].stsAB[CH1] && mPayload[iv->id].retransmits<2) {}
+                                                //first try to get missing sts for first channel a second time
+                                            else if (!mPayload[iv->id].stsAB[CH2] || !mPayload[iv->id].dataAB[CH2] ) {
+                                                cmd = 0x11;
                                                 change = true;
-                                        } else if ( cmd == 0x09 ) {//MI single or dual channel device
-                                            if ( mPayload[iv->id].dataAB[CH1] && iv->type == INV_TYPE_2CH  ) {
-                                                if (!mPayload[iv->id].stsAB[CH1] && mPayload[iv->id].retransmits<2) {}
-                                                    //first try to get missing sts for first channel a second time
-                                                else if (!mPayload[iv->id].stsAB[CH2] || !mPayload[iv->id].dataAB[CH2] ) {
-                                                    cmd = 0x11;
-                                                    change = true;
-                                                    mPayload[iv->id].retransmits = 0; //reset counter
-                                                }
-                                            }
-                                        } else if ( cmd == 0x11) {
-                                            if ( mPayload[iv->id].dataAB[CH2] ) { // data + status ch2 are there?
-                                                if (mPayload[iv->id].stsAB[CH2] && (!mPayload[iv->id].stsAB[CH1] || !mPayload[iv->id].dataAB[CH1])) {
-                                                    cmd = 0x09;
-                                                    change = true;
-                                                }
+                                                mPayload[iv->id].retransmits = 0; //reset counter
                                             }
                                         }
-                                        DPRINT_IVID(DBG_INFO, iv->id);
-                                        if (change) {
-                                            DBGPRINT(F("next request is"));
-                                            //mPayload[iv->id].skipfirstrepeat = 0;
-                                            mPayload[iv->id].txCmd = cmd;
-                                        } else {
-                                            DBGPRINT(F("sth."));
-                                            DBGPRINT(F(" missing: Request Retransmit"));
+                                    } else if ( cmd == 0x11) {
+                                        if ( mPayload[iv->id].dataAB[CH2] ) { // data + status ch2 are there?
+                                            if (mPayload[iv->id].stsAB[CH2] && (!mPayload[iv->id].stsAB[CH1] || !mPayload[iv->id].dataAB[CH1])) {
+                                                cmd = 0x09;
+                                                change = true;
+                                            }
                                         }
-                                        DBGPRINT(F(" 0x"));
-                                        DBGHEXLN(cmd);
-                                        mSys->Radio.sendCmdPacket(iv->radioId.u64, cmd, cmd, true, false);
-                                        //mSys->Radio.prepareDevInformCmd(iv->radioId.u64, cmd, mPayload[iv->id].ts, iv->alarmMesIndex, true, cmd);
-                                        yield();
                                     }
+                                    DPRINT_IVID(DBG_INFO, iv->id);
+                                    if (change) {
+                                        DBGPRINT(F("next request is"));
+                                        //mPayload[iv->id].skipfirstrepeat = 0;
+                                        mPayload[iv->id].txCmd = cmd;
+                                    } else {
+                                        DBGPRINT(F("sth."));
+                                        DBGPRINT(F(" missing: Request Retransmit"));
+                                    }
+                                    DBGPRINT(F(" 0x"));
+                                    DBGHEXLN(cmd);
+                                    mSys->Radio.sendCmdPacket(iv, cmd, cmd, true, false);
+                                    //mSys->Radio.prepareDevInformCmd(iv, cmd, mPayload[iv->id].ts, iv->alarmMesIndex, true, cmd);
+                                    yield();
                                 }
                             }
                         }
-                    } else if(!crcPass && pyldComplete) { // crc error on complete Payload
-                        if (mPayload[iv->id].retransmits < mMaxRetrans) {
-                            mPayload[iv->id].retransmits++;
-                            DPRINT_IVID(DBG_WARN, iv->id);
-                            DBGPRINTLN(F("CRC Error: Request Complete Retransmit"));
-                            mPayload[iv->id].txCmd = iv->getQueuedCmd();
-                            DPRINT_IVID(DBG_INFO, iv->id);
+                    }
+                } else if(!crcPass && pyldComplete) { // crc error on complete Payload
+                    if (mPayload[iv->id].retransmits < iv->rfRetr.budget) {
+                        mPayload[iv->id].retransmits++;
+                        DPRINT_IVID(DBG_WARN, iv->id);
+                        DBGPRINTLN(F("CRC Error: Request Complete Retransmit"));
+                        mPayload[iv->id].txCmd = iv->getQueuedCmd();
+                        DPRINT_IVID(DBG_INFO, iv->id);
 
-                            DBGPRINT(F("prepareDevInformCmd 0x"));
-                            DBGHEXLN(mPayload[iv->id].txCmd);
-                            //mSys->Radio.prepareDevInformCmd(iv->radioId.u64, mPayload[iv->id].txCmd, mPayload[iv->id].ts, iv->alarmMesIndex, true);
-                            mSys->Radio.sendCmdPacket(iv->radioId.u64, mPayload[iv->id].txCmd, mPayload[iv->id].txCmd, false, false);
-                        }
+                        DBGPRINT(F("prepareDevInformCmd 0x"));
+                        DBGHEXLN(mPayload[iv->id].txCmd);
+                        //mSys->Radio.prepareDevInformCmd(iv, mPayload[iv->id].txCmd, mPayload[iv->id].ts, iv->alarmMesIndex, true);
+                        mSys->Radio.sendCmdPacket(iv, mPayload[iv->id].txCmd, mPayload[iv->id].txCmd, false, false);
                     }
-                    /*else {  // payload complete
-                        //This tree is not really tested, most likely it's not truly complete....
-                        DPRINTLN(DBG_INFO, F("procPyld: cmd:  0x") + String(mPayload[iv->id].txCmd, HEX));
-                        DPRINTLN(DBG_INFO, F("procPyld: txid: 0x") + String(mPayload[iv->id].txId, HEX));
-                        //DPRINTLN(DBG_DEBUG, F("procPyld: max:  ") + String(mPayload[iv->id].maxPackId));
-                        //record_t<> *rec = iv->getRecordStruct(mPayload[iv->id].txCmd);  // choose the parser
-                        //uint8_t payload[128];
-                        //uint8_t payloadLen = 0;
-                        //memset(payload, 0, 128);
-                        //for (uint8_t i = 0; i < (mPayload[iv->id].maxPackId); i++) {
-                        //    memcpy(&payload[payloadLen], mPayload[iv->id].data[i], (mPayload[iv->id].len[i]));
-                        //    payloadLen += (mPayload[iv->id].len[i]);
-                        //    yield();
-                        //}
-                        //payloadLen -= 2;
-                        //if (mSerialDebug) {
-                        //    DPRINT(DBG_INFO, F("Payload (") + String(payloadLen) + "): ");
-                        //    mSys->Radio.dumpBuf(payload, payloadLen);
-                        //}
-                        //if (NULL == rec) {
-                        //    DPRINTLN(DBG_ERROR, F("record is NULL!"));
-                        //} else if ((rec->pyldLen == payloadLen) || (0 == rec->pyldLen)) {
-                        //    if (mPayload[iv->id].txId == (TX_REQ_INFO + ALL_FRAMES))
-                        //        mStat->rxSuccess++;
-                        //    rec->ts = mPayload[iv->id].ts;
-                        //    for (uint8_t i = 0; i < rec->length; i++) {
-                        //        iv->addValue(i, payload, rec);
-                        //        yield();
-                        //    }
-                        //    iv->doCalculations();
-                        //    notify(mPayload[iv->id].txCmd);
-                        //    if(AlarmData == mPayload[iv->id].txCmd) {
-                        //        uint8_t i = 0;
-                        //        uint16_t code;
-                        //        uint32_t start, end;
-                        //        while(1) {
-                        //            code = iv->parseAlarmLog(i++, payload, payloadLen, &start, &end);
-                        //            if(0 == code)
-                        //                break;
-                        //            if (NULL != mCbAlarm)
-                        //                (mCbAlarm)(code, start, end);
-                        //            yield();
-                        //        }
-                        //    }
-                        //} else {
-                        //    DPRINTLN(DBG_ERROR, F("plausibility check failed, expected ") + String(rec->pyldLen) + F(" bytes"));
-                        //    mStat->rxFail++;
-                        //}
-                        //iv->setQueuedCmdFinished();
-                    //}*/
                 }
-                yield();
+                /*else {  // payload complete
+                    //This tree is not really tested, most likely it's not truly complete....
+                    DPRINTLN(DBG_INFO, F("procPyld: cmd:  0x") + String(mPayload[iv->id].txCmd, HEX));
+                    DPRINTLN(DBG_INFO, F("procPyld: txid: 0x") + String(mPayload[iv->id].txId, HEX));
+                    //DPRINTLN(DBG_DEBUG, F("procPyld: max:  ") + String(mPayload[iv->id].maxPackId));
+                    //record_t<> *rec = iv->getRecordStruct(mPayload[iv->id].txCmd);  // choose the parser
+                    //uint8_t payload[128];
+                    //uint8_t payloadLen = 0;
+                    //memset(payload, 0, 128);
+                    //for (uint8_t i = 0; i < (mPayload[iv->id].maxPackId); i++) {
+                    //    memcpy(&payload[payloadLen], mPayload[iv->id].data[i], (mPayload[iv->id].len[i]));
+                    //    payloadLen += (mPayload[iv->id].len[i]);
+                    //    yield();
+                    //}
+                    //payloadLen -= 2;
+                    //if (mSerialDebug) {
+                    //    DPRINT(DBG_INFO, F("Payload (") + String(payloadLen) + "): ");
+                    //    mSys->Radio.dumpBuf(payload, payloadLen);
+                    //}
+                    //if (NULL == rec) {
+                    //    DPRINTLN(DBG_ERROR, F("record is NULL!"));
+                    //} else if ((rec->pyldLen == payloadLen) || (0 == rec->pyldLen)) {
+                    //    if (mPayload[iv->id].txId == (TX_REQ_INFO + ALL_FRAMES))
+                    //        mStat->rxSuccess++;
+                    //    rec->ts = mPayload[iv->id].ts;
+                    //    for (uint8_t i = 0; i < rec->length; i++) {
+                    //        iv->addValue(i, payload, rec);
+                    //        yield();
+                    //    }
+                    //    iv->doCalculations();
+                    //    notify(mPayload[iv->id].txCmd);
+                    //    if(AlarmData == mPayload[iv->id].txCmd) {
+                    //        uint8_t i = 0;
+                    //        uint16_t code;
+                    //        uint32_t start, end;
+                    //        while(1) {
+                    //            code = iv->parseAlarmLog(i++, payload, payloadLen, &start, &end);
+                    //            if(0 == code)
+                    //                break;
+                    //            if (NULL != mCbAlarm)
+                    //                (mCbAlarm)(code, start, end);
+                    //            yield();
+                    //        }
+                    //    }
+                    //} else {
+                    //    DPRINTLN(DBG_ERROR, F("plausibility check failed, expected ") + String(rec->pyldLen) + F(" bytes"));
+                    //    mStat->rxFail++;
+                    //}
+                    //iv->setQueuedCmdFinished();
+                //}*/
             }
         }
 
-    private:
-        void notify(uint8_t val) {
-            if(NULL != mCbMiPayload)
-                (mCbMiPayload)(val);
-        }
-
         void miStsDecode(Inverter<> *iv, packet_t *p, uint8_t stschan = CH1) {
             //DPRINTLN(DBG_INFO, F("(#") + String(iv->id) + F(") status msg 0x") + String(p->packet[0], HEX));
             record_t<> *rec = iv->getRecordStruct(RealTimeRunData_Debug);  // choose the record structure
@@ -612,7 +530,7 @@ const byteAssign_t InfoAssignment[] = {
             }
 
             if (iv->alarmMesIndex < rec->record[iv->getPosByChFld(0, FLD_EVT, rec)]){
-                iv->alarmMesIndex = rec->record[iv->getPosByChFld(0, FLD_EVT, rec)]; // seems there's no status per channel in 3rd gen. models?!?
+                iv->alarmMesIndex = ah::toInt(rec->record[iv->getPosByChFld(0, FLD_EVT, rec)]); // seems there's no status per channel in 3rd gen. models?!?
 
                 DPRINT_IVID(DBG_INFO, iv->id);
                 DBGPRINT(F("alarm ID incremented to "));
@@ -655,7 +573,7 @@ const byteAssign_t InfoAssignment[] = {
             iv->setValue(iv->getPosByChFld(datachan, FLD_YD, rec), rec, (float)((p->packet[19] << 8) + p->packet[20])/1);
             yield();
             iv->setValue(iv->getPosByChFld(0, FLD_T, rec), rec, (float) ((int16_t)(p->packet[21] << 8) + p->packet[22])/10);
-            iv->setValue(iv->getPosByChFld(0, FLD_IRR, rec), rec, (float) (calcIrradiation(iv, datachan)));
+            iv->setValue(iv->getPosByChFld(0, FLD_IRR, rec), rec, calcIrradiation(iv, datachan));
 
             if ( datachan < 3 ) {
                 mPayload[iv->id].dataAB[datachan] = true;
@@ -683,7 +601,7 @@ const byteAssign_t InfoAssignment[] = {
 
                 if (p->packet[0] < (0x39 + ALL_FRAMES) ) {
                     /*uint8_t cmd = p->packet[0] - ALL_FRAMES + 1;
-                    mSys->Radio.prepareDevInformCmd(iv->radioId.u64, cmd, mPayload[iv->id].ts, iv->alarmMesIndex, false, cmd);
+                    mSys->Radio.prepareDevInformCmd(iv, cmd, mPayload[iv->id].ts, iv->alarmMesIndex, false, cmd);
                     mPayload[iv->id].txCmd = cmd;*/
                     mPayload[iv->id].txCmd++;
                     mPayload[iv->id].retransmits = 0; // reserve retransmissions for each response
@@ -713,7 +631,7 @@ const byteAssign_t InfoAssignment[] = {
                     code = iv->parseAlarmLog(i++, payload, payloadLen, &start, &end);
                     if(0 == code)
                         break;
-                    if (NULL != mCbMiAlarm)
+                    if (NULL != mCbAlarm)
                         (mCbAlarm)(code, start, end);
                     yield();
                 }
@@ -742,17 +660,18 @@ const byteAssign_t InfoAssignment[] = {
             for(uint8_t i = 1; i <= iv->channels; i++) {
                 if (mPayload[iv->id].sts[i] == 3) {
                     uint8_t pos = iv->getPosByChFld(i, FLD_PDC, rec);
-                    ac_pow += iv->getValue(pos, rec);
+                    ac_pow += ah::toFloat(iv->getValue(pos, rec));
                 }
             }
             ac_pow = (int) (ac_pow*9.5);
             iv->setValue(iv->getPosByChFld(0, FLD_PAC, rec), rec, (float) ac_pow/10);
 
-            iv->doCalculations();
             iv->setQueuedCmdFinished();
             mStat->rxSuccess++;
+            iv->addRfLatency(micros(), true); // the last status or data message completed the set
+            iv->finishRfLatency(mPayload[iv->id].retransmits);
             yield();
-            notify(RealTimeRunData_Debug); //iv->type == INV_TYPE_4CH ? 0x36 : 0x09 );
+            notify(RealTimeRunData_Debug, iv); //iv->type == INV_TYPE_4CH ? 0x36 : 0x09 );
         }
 
         bool build(uint8_t id, bool *complete) {
@@ -824,17 +743,15 @@ const byteAssign_t InfoAssignment[] = {
 
 
 
-        IApp *mApp;
-        HMSYSTEM *mSys;
-        statistics_t *mStat;
-        uint8_t mMaxRetrans;
-        uint32_t *mTimestamp;
-        miPayload_t mPayload[MAX_NUM_INVERTERS];
-        bool mSerialDebug;
-
-        Inverter<> *mHighPrioIv;
-        alarmListenerType mCbMiAlarm;
-        payloadListenerType mCbMiPayload;
+        using Base::notify;
+        using Base::mApp;
+        using Base::mSys;
+        using Base::mStat;
+        using Base::mTimestamp;
+        using Base::mPayload;
+        using Base::mSerialDebug;
+        using Base::mHighPrioIv;
+        using Base::mCbAlarm;
 };
 
 #endif /*__MI_PAYLOAD_H__*/
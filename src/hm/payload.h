@@ -0,0 +1,193 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __PAYLOAD_H__
+#define __PAYLOAD_H__
+
+#include "../utils/dbg.h"
+#include "../config/config.h"
+#include <Arduino.h>
+
+// the record of cmd is complete, its dirty mask holds the changed fields and
+// is cleared after the listener returned
+typedef std::function<void(uint8_t cmd, Inverter<> *iv)> payloadListenerType;
+typedef std::function<void(uint16_t alarmCode, uint32_t start, uint32_t end)> alarmListenerType;
+
+//-----------------------------------------------------------------------------
+// Protocol engine
+// request handling, failure statistics and listeners shared by all inverter
+// generations. GEN is the generation (HmPayload, MiPayload) which derives from
+// the engine, its hooks are bound at compile time:
+//   IV_GEN                     generation of the handled inverters
+//   init(id)                   state at startup
+//   reset(id)                  clears the state for a new request
+//   gotNothing(id)             nothing was received for the request
+//   sendDevControl(iv)         transmits the dev control command of iv
+//   sendInfo(iv)               transmits the next queued command of iv
+//   processIv(iv, retransmit)  checks completion, decodes or retransmits (at
+//                              most iv->rfRetr.budget times)
+// PAYLOAD is the state per inverter, it needs the members requested,
+// complete, retransmits and txCmd.
+//-----------------------------------------------------------------------------
+template<class HMSYSTEM, class GEN, class PAYLOAD>
+class Payload {
+    public:
+        void setup(IApp *app, HMSYSTEM *sys, statistics_t *stat, uint8_t maxRetransmits, uint32_t *timestamp) {
+            mApp        = app;
+            mSys        = sys;
+            mStat       = stat;
+            mMaxRetrans = maxRetransmits;
+            mTimestamp  = timestamp;
+            for(uint8_t i = 0; i < MAX_NUM_INVERTERS; i++) {
+                gen()->init(i);
+            }
+            mSerialDebug  = false;
+            mHighPrioIv   = NULL;
+            mCbAlarm      = NULL;
+            mCbPayload    = NULL;
+        }
+
+        void enableSerialDebug(bool enable) {
+            mSerialDebug = enable;
+        }
+
+        void addPayloadListener(payloadListenerType cb) {
+            mCbPayload = cb;
+        }
+
+        void addAlarmListener(alarmListenerType cb) {
+            mCbAlarm = cb;
+        }
+
+        void loop() {
+            if (NULL != mHighPrioIv) {
+                ivSend(mHighPrioIv, true); // for e.g. devcontrol commands
+                mHighPrioIv = NULL;
+            }
+        }
+
+        void ivSendHighPrio(Inverter<> *iv) {
+            mHighPrioIv = iv;
+        }
+
+        void ivSend(Inverter<> *iv, bool highPrio = false) {
+            if(!highPrio) {
+                if (mPayload[iv->id].requested) {
+                    if (!mPayload[iv->id].complete)
+                        process(false); // no retransmit
+
+                    uint8_t result = RF_RETR_OK;
+                    if (!mPayload[iv->id].complete) {
+                        if (mSerialDebug)
+                            DPRINT_IVID(DBG_INFO, iv->id);
+                        result = RF_RETR_PARTIAL;
+                        if (gen()->gotNothing(iv->id)) {
+                            result = RF_RETR_NONE;
+                            mStat->rxFailNoAnser++; // got nothing
+                            if (mSerialDebug)
+                                DBGPRINTLN(F("enqueued cmd failed/timeout"));
+                        } else {
+                            mStat->rxFail++; // got fragments but not complete response
+                            if (mSerialDebug) {
+                                DBGPRINT(F("no complete Payload received! (retransmits: "));
+                                DBGPRINT(String(mPayload[iv->id].retransmits));
+                                DBGPRINTLN(F(")"));
+                            }
+                        }
+                        iv->setQueuedCmdFinished();  // command failed
+                    }
+                    iv->updateRetrBudget(result, mPayload[iv->id].retransmits, mMaxRetrans);
+                }
+            }
+            if (!iv->rfRetr.learned && (0 == iv->rfRetr.noAnswer))
+                iv->rfRetr.budget = mMaxRetrans; // nothing known about the link yet
+
+            gen()->reset(iv->id);
+            mPayload[iv->id].requested = true;
+
+            yield();
+            if (mSerialDebug) {
+                DPRINT_IVID(DBG_INFO, iv->id);
+                DBGPRINT(F("Requesting Inv SN "));
+                DBGPRINTLN(String(iv->config->serial.u64, HEX));
+            }
+
+            iv->clearRxDup();
+            if (iv->getDevControlRequest()) {
+                if (mSerialDebug) {
+                    DPRINT_IVID(DBG_INFO, iv->id);
+                    DBGPRINT(F("Devcontrol request 0x"));
+                    DBGPRINT(String(iv->devControlCmd, HEX));
+                    DBGPRINT(F(" power limit "));
+                    DBGPRINTLN(String(iv->powerLimit[0]));
+                }
+                iv->startRfLatency(iv->devControlCmd, true);
+                gen()->sendDevControl(iv);
+                mPayload[iv->id].txCmd = iv->devControlCmd;
+            } else
+                gen()->sendInfo(iv);
+        }
+
+        // starts a payload from a recorded request (capture replay), nothing is sent
+        void replayRequest(Inverter<> *iv, uint8_t cmd) {
+            gen()->reset(iv->id);
+            mPayload[iv->id].txCmd = cmd;
+            iv->rfLatReq.running = false;
+            iv->clearRxDup();
+        }
+
+        // the last request of the inverter was answered completely
+        bool isComplete(Inverter<> *iv) {
+            return mPayload[iv->id].complete;
+        }
+
+        void process(bool retransmit) {
+            for (uint8_t id = 0; id < mSys->getNumInverters(); id++) {
+                Inverter<> *iv = mSys->getInverterByPos(id);
+                if (NULL == iv)
+                    continue; // skip to next inverter
+
+                if (GEN::IV_GEN != iv->ivGen) // only process inverters of this generation
+                    continue; // skip to next inverter
+
+                gen()->processIv(iv, retransmit);
+                yield();
+            }
+        }
+
+    protected:
+        Payload() {}
+
+        inline GEN *gen(void) {
+            return static_cast<GEN*>(this);
+        }
+
+        void notify(uint8_t val, Inverter<> *iv) {
+            if(NULL != mCbPayload)
+                (mCbPayload)(val, iv);
+            record_t<> *rec = iv->getRecordStruct(val);
+            if(NULL != rec)
+                rec->dirty = 0;
+        }
+
+        void notify(uint16_t code, uint32_t start, uint32_t endTime) {
+            if (NULL != mCbAlarm)
+                (mCbAlarm)(code, start, endTime);
+        }
+
+        IApp *mApp;
+        HMSYSTEM *mSys;
+        statistics_t *mStat;
+        uint8_t mMaxRetrans;
+        uint32_t *mTimestamp;
+        PAYLOAD mPayload[MAX_NUM_INVERTERS];
+        bool mSerialDebug;
+
+        Inverter<> *mHighPrioIv;
+        alarmListenerType mCbAlarm;
+        payloadListenerType mCbPayload;
+};
+
+#endif /*__PAYLOAD_H__*/
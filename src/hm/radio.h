@@ -0,0 +1,286 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __RADIO_H__
+#define __RADIO_H__
+
+#include "../utils/dbg.h"
+#include "../utils/crc.h"
+#include "../utils/spscRing.h"
+#include "../config/config.h"
+#include "hmInverter.h"
+#include "radioCapture.h"
+
+#define RF_LISTEN_WINDOW_MS 400     // max. time to wait for all fragments of one request
+#define RF_CH_DWELL_US      5110    // listen time on each RX channel before hopping
+#define RF_FIRST_DWELL_MAX_US (4 * RF_CH_DWELL_US) // max. listen time on the predicted channel
+#define RF_BURST_GAP_MAX_US   (2 * RF_CH_DWELL_US) // max. listen time between the requests of a burst
+
+#define TX_REQ_INFO         0x15
+#define TX_REQ_DEVCONTROL   0x51
+#define ALL_FRAMES          0x80
+#define SINGLE_FRAME        0x81
+
+// receive states, advanced by the loop() of the radio
+// RF_BURST_GAP: listening between two requests of a retransmit burst
+enum {RF_IDLE = 0, RF_TX_PENDING, RF_BURST_GAP, RF_LISTEN, RF_DONE};
+
+
+//-----------------------------------------------------------------------------
+// MACROS
+//-----------------------------------------------------------------------------
+#define CP_U32_LittleEndian(buf, v) ({ \
+    uint8_t *b = buf; \
+    b[0] = ((v >> 24) & 0xff); \
+    b[1] = ((v >> 16) & 0xff); \
+    b[2] = ((v >>  8) & 0xff); \
+    b[3] = ((v      ) & 0xff); \
+})
+
+#define CP_U32_BigEndian(buf, v) ({ \
+    uint8_t *b = buf; \
+    b[3] = ((v >> 24) & 0xff); \
+    b[2] = ((v >> 16) & 0xff); \
+    b[1] = ((v >>  8) & 0xff); \
+    b[0] = ((v      ) & 0xff); \
+})
+
+#define BIT_CNT(x)  ((x)<<3)
+
+//-----------------------------------------------------------------------------
+// Radio interface
+// builds the request frames, the backend (NRF24 or simulation) transmits them
+// and fills mBufCtrl with the received fragments
+//-----------------------------------------------------------------------------
+class Radio {
+    public:
+        virtual ~Radio() {}
+
+        // non blocking, returns true once per finished listen window
+        virtual bool loop(void) = 0;
+        // a request is transmitted or its answer is awaited
+        virtual bool isBusy(void) = 0;
+        virtual bool isChipConnected(void) = 0;
+        virtual uint8_t getDataRate(void) = 0;
+        virtual bool isPVariant(void) = 0;
+        virtual uint8_t getRfChannel(uint8_t idx) = 0;
+
+        void handleIntr(void) {
+            mIrqRcvd = true;
+        }
+
+        void enableDebug() {
+            mSerialDebug = true;
+        }
+
+        void setCapture(RadioCapture *cap) {
+            mCapture = cap;
+        }
+
+        void sendControlPacket(Inverter<> *iv, uint8_t cmd, uint16_t *data, bool isRetransmit, bool isNoMI = true) {
+            DPRINT(DBG_INFO, F("sendControlPacket cmd: 0x"));
+            DBGHEXLN(cmd);
+            endBurst();
+            initPacket(iv->radioId.u64, TX_REQ_DEVCONTROL, SINGLE_FRAME);
+            uint8_t cnt = 10;
+            if (isNoMI) {
+                mTxBuf[cnt++] = cmd; // cmd -> 0 on, 1 off, 2 restart, 11 active power, 12 reactive power, 13 power factor
+                mTxBuf[cnt++] = 0x00;
+                if(cmd >= ActivePowerContr && cmd <= PFSet) { // ActivePowerContr, ReactivePowerContr, PFSet
+                    mTxBuf[cnt++] = ((data[0] * 10) >> 8) & 0xff; // power limit
+                    mTxBuf[cnt++] = ((data[0] * 10)     ) & 0xff; // power limit
+                    mTxBuf[cnt++] = ((data[1]     ) >> 8) & 0xff; // setting for persistens handlings
+                    mTxBuf[cnt++] = ((data[1]     )     ) & 0xff; // setting for persistens handling
+                }
+            } else { //MI 2nd gen. specific
+                switch (cmd) {
+                    case TurnOn:
+                        //mTxBuf[0] = 0x50;
+                        mTxBuf[9] = 0x55;
+                        mTxBuf[10] = 0xaa;
+                        break;
+                    case TurnOff:
+                        mTxBuf[9] = 0xaa;
+                        mTxBuf[10] = 0x55;
+                        break;
+                    case ActivePowerContr:
+                        cnt++;
+                        mTxBuf[9] = 0x5a;
+                        mTxBuf[10] = 0x5a;
+                        mTxBuf[11] = data[0]; // power limit
+                        break;
+                    default:
+                        return;
+                }
+                cnt++;
+            }
+            sendPacket(iv, cnt, isRetransmit, isNoMI);
+        }
+
+        void prepareDevInformCmd(Inverter<> *iv, uint8_t cmd, uint32_t ts, uint16_t alarmMesId, bool isRetransmit, uint8_t reqfld=TX_REQ_INFO) { // might not be necessary to add additional arg.
+            if(mSerialDebug) {
+                DPRINT(DBG_DEBUG, F("prepareDevInformCmd 0x"));
+                DPRINTLN(DBG_DEBUG,String(cmd, HEX));
+            }
+            endBurst();
+            initPacket(iv->radioId.u64, reqfld, ALL_FRAMES);
+            mTxBuf[10] = cmd; // cid
+            mTxBuf[11] = 0x00;
+            CP_U32_LittleEndian(&mTxBuf[12], ts);
+            if (cmd == RealTimeRunData_Debug || cmd == AlarmData ) {
+                mTxBuf[18] = (alarmMesId >> 8) & 0xff;
+                mTxBuf[19] = (alarmMesId     ) & 0xff;
+            }
+            sendPacket(iv, 24, isRetransmit, true);
+        }
+
+        void sendCmdPacket(Inverter<> *iv, uint8_t mid, uint8_t pid, bool isRetransmit, bool appendCrc16=true) {
+            endBurst();
+            initPacket(iv->radioId.u64, mid, pid);
+            sendPacket(iv, 10, isRetransmit, appendCrc16);
+        }
+
+        // requests several single fragments back to back (selective repeat),
+        // the answers are collected in one listen window. Only the first
+        // request is sent here, the loop() of the backend sends the others
+        // with sendBurstNext()
+        void sendCmdBurst(Inverter<> *iv, uint8_t mid, uint8_t pid[], uint8_t cnt) {
+            if(0 == cnt)
+                return;
+            if(cnt > MAX_PAYLOAD_ENTRIES)
+                cnt = MAX_PAYLOAD_ENTRIES;
+            memcpy(mTxBurstPid, pid, cnt);
+            mTxBurstIv  = iv;
+            mTxBurstMid = mid;
+            mTxFrames   = cnt;
+            mTxBurstIdx = 0;
+            initPacket(iv->radioId.u64, mid, mTxBurstPid[0]);
+            sendPacket(iv, 10, true);
+            if(isLastOfBurst())
+                endBurst();
+        }
+
+        void dumpBuf(uint8_t buf[], uint8_t len) {
+            //DPRINTLN(DBG_VERBOSE, F("radio.h:dumpBuf"));
+            for(uint8_t i = 0; i < len; i++) {
+                DHEX(buf[i]);
+                DBGPRINT(" ");
+            }
+            DBGPRINTLN("");
+        }
+
+        ah::SpscRing<packet_t, PACKET_BUFFER_SIZE> mBufCtrl;
+
+        uint32_t mSendCnt;
+        uint32_t mRetransmits;
+
+        bool mSerialDebug;
+
+    protected:
+        Radio() {
+            mSendCnt     = 0;
+            mRetransmits = 0;
+            mSerialDebug = false;
+            mIrqRcvd     = false;
+            DTU_RADIO_ID = 0ULL;
+            mCapture     = NULL;
+            mTxFrames    = 1;
+            mTxBurstIdx  = 0;
+            mTxBurstIv   = NULL;
+            mTxBurstMid  = 0;
+        }
+
+        // transmits mTxBuf, len excludes the crc's which are appended by finishPacket()
+        virtual void sendPacket(Inverter<> *iv, uint8_t len, bool isRetransmit, bool appendCrc16=true) = 0;
+
+        void generateDtuSn(void) {
+            uint32_t dtuSn = 0x87654321;
+            uint32_t chipID = 0; // will be filled with last 3 bytes of MAC
+            #ifdef ESP32
+            uint64_t MAC = ESP.getEfuseMac();
+            chipID = ((MAC >> 8) & 0xFF0000) | ((MAC >> 24) & 0xFF00) | ((MAC >> 40) & 0xFF);
+            #else
+            chipID = ESP.getChipId();
+            #endif
+            if(chipID) {
+                dtuSn = 0x80000000; // the first digit is an 8 for DTU production year 2022, the rest is filled with the ESP chipID in decimal
+                for(int i = 0; i < 7; i++) {
+                    dtuSn |= (chipID % 10) << (i * 4);
+                    chipID /= 10;
+                }
+            }
+            // change the byte order of the DTU serial number and append the required 0x01 at the end
+            DTU_RADIO_ID = ((uint64_t)(((dtuSn >> 24) & 0xFF) | ((dtuSn >> 8) & 0xFF00) | ((dtuSn << 8) & 0xFF0000) | ((dtuSn << 24) & 0xFF000000)) << 8) | 0x01;
+        }
+
+        void initPacket(uint64_t invId, uint8_t mid, uint8_t pid) {
+            if(mSerialDebug) {
+                DPRINT(DBG_VERBOSE, F("initPacket, mid: "));
+                DHEX(mid);
+                DBGPRINT(F(" pid: "));
+                DBGHEXLN(pid);
+            }
+            memset(mTxBuf, 0, MAX_RF_PAYLOAD_SIZE);
+            mTxBuf[0] = mid; // message id
+            CP_U32_BigEndian(&mTxBuf[1], (invId  >> 8));
+            CP_U32_BigEndian(&mTxBuf[5], (DTU_RADIO_ID >> 8));
+            mTxBuf[9]  = pid;
+        }
+
+        // appends the crc's and returns the length of the whole frame
+        uint8_t finishPacket(uint8_t len, bool appendCrc16) {
+            if (appendCrc16 && (len > 10)) {
+                // crc control data
+                uint16_t crc = ah::crc16(&mTxBuf[10], len - 10);
+                mTxBuf[len++] = (crc >> 8) & 0xff;
+                mTxBuf[len++] = (crc     ) & 0xff;
+            }
+            // crc over all
+            mTxBuf[len] = ah::crc8(mTxBuf, len);
+            return len + 1;
+        }
+
+        inline bool isFirstOfBurst(void) {
+            return (0 == mTxBurstIdx);
+        }
+
+        inline bool isLastOfBurst(void) {
+            return ((mTxBurstIdx + 1) >= mTxFrames);
+        }
+
+        // sends the next request of the running burst
+        void sendBurstNext(void) {
+            if(isLastOfBurst() || (NULL == mTxBurstIv))
+                return;
+            mTxBurstIdx++;
+            initPacket(mTxBurstIv->radioId.u64, mTxBurstMid, mTxBurstPid[mTxBurstIdx]);
+            sendPacket(mTxBurstIv, 10, true);
+            if(isLastOfBurst())
+                endBurst();
+        }
+
+        // the next request is a single one
+        inline void endBurst(void) {
+            mTxFrames   = 1;
+            mTxBurstIdx = 0;
+        }
+
+        inline void capture(uint8_t flags, uint8_t ch, uint8_t buf[], uint8_t len, uint32_t ts) {
+            if(NULL != mCapture)
+                mCapture->add(flags, ch, buf, len, ts);
+        }
+
+        volatile bool mIrqRcvd;
+        uint64_t DTU_RADIO_ID;
+        RadioCapture *mCapture;
+        uint8_t mTxBuf[MAX_RF_PAYLOAD_SIZE];
+        uint8_t mTxFrames;   // number of requests in the running burst
+        uint8_t mTxBurstIdx; // request of the burst which is sent
+        Inverter<> *mTxBurstIv;
+        uint8_t mTxBurstMid;
+        uint8_t mTxBurstPid[MAX_PAYLOAD_ENTRIES];
+};
+
+#endif /*__RADIO_H__*/
@@ -0,0 +1,184 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __RADIO_CAPTURE_H__
+#define __RADIO_CAPTURE_H__
+
+#include <LittleFS.h>
+#include "../utils/dbg.h"
+#include "../utils/spscRing.h"
+#include "../config/config.h"
+
+#define CAPTURE_FILE        "/capture.bin"
+#define CAPTURE_MAGIC       0x31504341  // "ACP1"
+#define CAPTURE_MAX_RECORDS 512         // ring size in the file (512 * 40 bytes)
+#define CAPTURE_BUF_SIZE    24          // records staged in RAM, allocated while the capture runs
+#define CAPTURE_FLUSH_MS    5000        // staged records are written at the latest after this time
+
+// record flags
+#define CAPTURE_TX          0x01        // request sent by the DTU
+#define CAPTURE_RETRANSMIT  0x02        // request was a retransmit
+#define CAPTURE_CRC_FAIL    0x04        // received fragment with invalid crc8
+
+// file layout (little endian): capHeader_t followed by CAPTURE_MAX_RECORDS
+// capRecord_t, the oldest record is at (next - cnt) modulo CAPTURE_MAX_RECORDS
+typedef struct {
+    uint32_t magic;
+    uint16_t next;  // index which is written next
+    uint16_t cnt;   // number of valid records
+} capHeader_t;
+
+typedef struct {
+    uint32_t ts;    // micros() of TX or RX
+    uint8_t  flags;
+    uint8_t  ch;    // RF channel
+    uint8_t  len;
+    uint8_t  res;
+    uint8_t  data[MAX_RF_PAYLOAD_SIZE];
+} capRecord_t;
+
+class RadioCapture {
+    public:
+        RadioCapture() {
+            mEnabled = false;
+            mBuf     = NULL;
+            mLostCnt = 0;
+            mFlushMs = 0;
+            mHdr.magic = CAPTURE_MAGIC;
+            mHdr.next  = 0;
+            mHdr.cnt   = 0;
+        }
+
+        void enable(bool en) {
+            if(en == mEnabled)
+                return;
+            if(en) {
+                if(!openFile())
+                    return;
+                mBuf = new ah::SpscRing<capRecord_t, CAPTURE_BUF_SIZE>();
+                if(NULL == mBuf) {
+                    mFp.close();
+                    DPRINTLN(DBG_ERROR, F("no memory for radio capture"));
+                    return;
+                }
+                mFlushMs = millis();
+                DPRINTLN(DBG_INFO, F("radio capture started"));
+            } else {
+                flush();
+                mFp.close();
+                mLostCnt += mBuf->getOverflowCnt();
+                delete mBuf;
+                mBuf = NULL;
+                DPRINTLN(DBG_INFO, F("radio capture stopped"));
+            }
+            mEnabled = en;
+        }
+
+        bool isEnabled(void) {
+            return mEnabled;
+        }
+
+        void clear(void) {
+            bool en = mEnabled;
+            enable(false);
+            LittleFS.remove(CAPTURE_FILE);
+            mHdr.next = 0;
+            mHdr.cnt  = 0;
+            enable(en);
+        }
+
+        // called by the radios, only stages the record in RAM
+        void add(uint8_t flags, uint8_t ch, uint8_t buf[], uint8_t len, uint32_t ts) {
+            if(!mEnabled)
+                return;
+            capRecord_t *r = mBuf->reserve();
+            if(NULL == r)
+                return; // counted as lost
+            r->ts    = ts;
+            r->flags = flags;
+            r->ch    = ch;
+            r->len   = (len > MAX_RF_PAYLOAD_SIZE) ? MAX_RF_PAYLOAD_SIZE : len;
+            r->res   = 0;
+            memcpy(r->data, buf, r->len);
+            mBuf->commit();
+        }
+
+        // called between the listen windows, the flash is written once the
+        // staging ring is half full or CAPTURE_FLUSH_MS have passed
+        void loop(void) {
+            if(!mEnabled)
+                return;
+            if((mBuf->size() >= (CAPTURE_BUF_SIZE / 2)) || ((millis() - mFlushMs) >= CAPTURE_FLUSH_MS))
+                flush();
+        }
+
+        uint16_t getCount(void) {
+            return mHdr.cnt;
+        }
+
+        uint32_t getLostCnt(void) {
+            return mLostCnt + ((NULL == mBuf) ? 0 : mBuf->getOverflowCnt());
+        }
+
+    private:
+        // writes the staged records to the file
+        void flush(void) {
+            mFlushMs = millis();
+            if(mBuf->empty())
+                return;
+            capRecord_t *r;
+            while(NULL != (r = mBuf->peek())) {
+                mFp.seek(sizeof(capHeader_t) + mHdr.next * sizeof(capRecord_t), SeekSet);
+                mFp.write((uint8_t*)r, sizeof(capRecord_t));
+                mBuf->pop();
+                if(++mHdr.next >= CAPTURE_MAX_RECORDS)
+                    mHdr.next = 0;
+                if(mHdr.cnt < CAPTURE_MAX_RECORDS)
+                    mHdr.cnt++;
+            }
+            mFp.seek(0, SeekSet);
+            mFp.write((uint8_t*)&mHdr, sizeof(capHeader_t));
+            mFp.flush();
+        }
+
+        // continues an existing capture, otherwise a new file is created
+        bool openFile(void) {
+            mFp = LittleFS.open(CAPTURE_FILE, "r+");
+            if(mFp) {
+                if(readHeader())
+                    return true;
+                mFp.close();
+            }
+            mHdr.next = 0;
+            mHdr.cnt  = 0;
+            mFp = LittleFS.open(CAPTURE_FILE, "w+");
+            if(!mFp) {
+                DPRINTLN(DBG_ERROR, F("can't create capture file"));
+                return false;
+            }
+            mFp.write((uint8_t*)&mHdr, sizeof(capHeader_t));
+            return true;
+        }
+
+        bool readHeader(void) {
+            capHeader_t hdr;
+            mFp.seek(0, SeekSet);
+            if(sizeof(capHeader_t) != mFp.read((uint8_t*)&hdr, sizeof(capHeader_t)))
+                return false;
+            if((CAPTURE_MAGIC != hdr.magic) || (hdr.next >= CAPTURE_MAX_RECORDS) || (hdr.cnt > CAPTURE_MAX_RECORDS))
+                return false;
+            mHdr = hdr;
+            return true;
+        }
+
+        bool mEnabled;
+        File mFp;
+        capHeader_t mHdr;
+        ah::SpscRing<capRecord_t, CAPTURE_BUF_SIZE> *mBuf; // only while enabled
+        uint32_t mLostCnt; // of the previous captures
+        uint32_t mFlushMs;
+};
+
+#endif /*__RADIO_CAPTURE_H__*/
@@ -0,0 +1,308 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __SIM_RADIO_H__
+#define __SIM_RADIO_H__
+
+#include "radio.h"
+
+// default RF medium, can be changed per channel with setMedium()
+#ifndef SIM_RADIO_LOSS_PCT
+#define SIM_RADIO_LOSS_PCT      10  // [%] fragments which get lost
+#endif
+#ifndef SIM_RADIO_DUP_PCT
+#define SIM_RADIO_DUP_PCT       5   // [%] fragments which are received twice
+#endif
+#ifndef SIM_RADIO_LATENCY_MS
+#define SIM_RADIO_LATENCY_MS    15  // [ms] time from request to first fragment
+#endif
+#define SIM_RADIO_FRAG_MS       2   // [ms] time between two fragments
+#define SIM_RADIO_FRAG_LEN      16  // payload bytes per fragment
+#define SIM_RADIO_AIR_SIZE      (2 * MAX_PAYLOAD_ENTRIES) // fragments on air incl. duplicates
+
+typedef struct {
+    uint8_t  loss;    // [%]
+    uint8_t  dup;     // [%]
+    uint16_t latency; // [ms]
+} simMedium_t;
+
+typedef struct {
+    packet_t pkt;
+    uint32_t due;     // millis() when the fragment arrives
+    bool     last;    // fragment ends the listen window
+} simFrame_t;
+
+//-----------------------------------------------------------------------------
+// Simulated radio
+// answers HM requests like an inverter would, the values are generated from
+// the assignment tables. MI (2nd gen) requests are not answered.
+//-----------------------------------------------------------------------------
+class SimRadio : public Radio {
+    public:
+        SimRadio() {
+            mRfChLst[0] = 03;
+            mRfChLst[1] = 23;
+            mRfChLst[2] = 40;
+            mRfChLst[3] = 61;
+            mRfChLst[4] = 75;
+            for(uint8_t i = 0; i < RF_CHANNELS; i++)
+                setMedium(i, SIM_RADIO_LOSS_PCT, SIM_RADIO_DUP_PCT, SIM_RADIO_LATENCY_MS);
+
+            mTxChIdx  = 2;
+            mRxChIdx  = (mTxChIdx + RF_RX_OFFSET_DEFAULT) % RF_CHANNELS;
+            mRxState  = RF_IDLE;
+            mTxIv     = NULL;
+            memset(mLastCmd, 0, MAX_NUM_INVERTERS);
+            memset(mLastTs, 0, sizeof(mLastTs));
+        }
+        ~SimRadio() {}
+
+        // same arguments as HmRadio, the pins are not used
+        void setup(uint8_t ampPwr = 0, uint8_t irq = 0, uint8_t ce = 0, uint8_t cs = 0, uint8_t sclk = 0, uint8_t mosi = 0, uint8_t miso = 0) {
+            generateDtuSn();
+            DPRINTLN(DBG_INFO, F("Radio: simulated RF medium"));
+        }
+
+        void setMedium(uint8_t idx, uint8_t loss, uint8_t dup, uint16_t latency) {
+            if(idx >= RF_CHANNELS)
+                return;
+            mMedium[idx].loss    = loss;
+            mMedium[idx].dup     = dup;
+            mMedium[idx].latency = latency;
+        }
+
+        bool loop(void) {
+            mIrqRcvd = false; // there is no interrupt line in simulation
+            // the simulated answers of a burst don't collide with the requests
+            while(!isLastOfBurst())
+                sendBurstNext();
+            if(RF_LISTEN != mRxState)
+                return false;
+
+            simFrame_t *f;
+            while(NULL != (f = mAir.peek())) {
+                if((int32_t)(millis() - f->due) < 0)
+                    break; // not yet arrived
+                packet_t *p = mBufCtrl.reserve();
+                if(NULL != p) {
+                    *p = f->pkt;
+                    p->ts = micros();
+                    capture(0, p->ch, p->packet, p->len, p->ts);
+                    mBufCtrl.commit();
+                }
+                if(NULL != mTxIv)
+                    mTxIv->rfStat[mRxChIdx].frames++;
+                bool last = f->last;
+                mAir.pop();
+                if(last) {
+                    mRxState = RF_DONE;
+                    break;
+                }
+            }
+
+            if((RF_DONE != mRxState) && ((millis() - mRxStartMillis) >= RF_LISTEN_WINDOW_MS))
+                mRxState = RF_DONE; // not finished but time is over
+
+            if(RF_DONE == mRxState) {
+                clearAir();
+                mRxState = RF_IDLE;
+                return true;
+            }
+            return false;
+        }
+
+        bool isBusy(void) {
+            return (RF_IDLE != mRxState);
+        }
+
+        bool isChipConnected(void) {
+            return true;
+        }
+
+        uint8_t getDataRate(void) {
+            return 2; // 250kbps
+        }
+
+        bool isPVariant(void) {
+            return true;
+        }
+
+        uint8_t getRfChannel(uint8_t idx) {
+            return mRfChLst[idx % RF_CHANNELS];
+        }
+
+    private:
+        void sendPacket(Inverter<> *iv, uint8_t len, bool isRetransmit, bool appendCrc16=true) {
+            len = finishPacket(len, appendCrc16);
+            if(isFirstOfBurst())
+                clearAir(); // a new request ends a running listen window
+
+            mTxChIdx = (mTxChIdx + 1) % RF_CHANNELS;
+            mRxChIdx = (mTxChIdx + RF_RX_OFFSET_DEFAULT) % RF_CHANNELS;
+
+            if(mSerialDebug) {
+                DPRINT(DBG_INFO, F("TX "));
+                DBGPRINT(String(len));
+                DBGPRINT("B Ch");
+                DBGPRINT(String(mRfChLst[mTxChIdx]));
+                DBGPRINT(F(" (sim) | "));
+                dumpBuf(mTxBuf, len);
+            }
+
+            capture(CAPTURE_TX | (isRetransmit ? CAPTURE_RETRANSMIT : 0), mRfChLst[mTxChIdx], mTxBuf, len, micros());
+            mTxIv = iv;
+            mRxStartMillis = millis();
+            mRxState = RF_LISTEN;
+            answer(iv);
+
+            if(!isFirstOfBurst())
+                return; // a burst is one request and is counted once
+            if(isRetransmit)
+                mRetransmits++;
+            else
+                mSendCnt++;
+        }
+
+        // puts the answer of the inverter to the request in mTxBuf on air
+        void answer(Inverter<> *iv) {
+            uint8_t mid = mTxBuf[0];
+            uint8_t pid = mTxBuf[9];
+            if(isFirstOfBurst())
+                mAirDue = millis() + mMedium[mRxChIdx].latency;
+            else
+                mAirDue += SIM_RADIO_FRAG_MS; // answers of a burst follow each other
+
+            if(TX_REQ_DEVCONTROL == mid) {
+                uint8_t data[4] = {0x00, 0x00, mTxBuf[10], 0x00}; // accepted
+                putOnAir(iv, mid, ALL_FRAMES, data, 4, isLastOfBurst());
+                return;
+            }
+            if((TX_REQ_INFO != mid) || (iv->id >= MAX_NUM_INVERTERS))
+                return; // MI request, not simulated
+
+            if(ALL_FRAMES == pid) {
+                mLastCmd[iv->id] = mTxBuf[10];
+                mLastTs[iv->id]  = ((uint32_t)mTxBuf[12] << 24) | ((uint32_t)mTxBuf[13] << 16) | ((uint32_t)mTxBuf[14] << 8) | mTxBuf[15];
+            }
+
+            uint8_t pyld[MAX_PAYLOAD_ENTRIES * SIM_RADIO_FRAG_LEN];
+            uint8_t len = buildPayload(iv, mLastCmd[iv->id], mLastTs[iv->id], pyld);
+            if(0 == len)
+                return;
+            uint8_t frags = (len + SIM_RADIO_FRAG_LEN - 1) / SIM_RADIO_FRAG_LEN;
+
+            for(uint8_t i = 1; i <= frags; i++) {
+                if((ALL_FRAMES != pid) && ((SINGLE_FRAME - 1 + i) != pid))
+                    continue; // retransmit of a single fragment
+                uint8_t n = (i == frags) ? (len - (i - 1) * SIM_RADIO_FRAG_LEN) : SIM_RADIO_FRAG_LEN;
+                bool last = isLastOfBurst() && ((i == frags) || (ALL_FRAMES != pid));
+                putOnAir(iv, mid, (i == frags) ? (ALL_FRAMES | i) : i, &pyld[(i - 1) * SIM_RADIO_FRAG_LEN], n, last);
+            }
+        }
+
+        // payload incl. crc16 with values generated from the timestamp of the request
+        uint8_t buildPayload(Inverter<> *iv, uint8_t cmd, uint32_t ts, uint8_t pyld[]) {
+            record_t<> *rec = iv->getRecordStruct(cmd);
+            if(NULL == rec)
+                return 0;
+
+            uint8_t len = rec->pyldLen;
+            if(0 == len) { // no length check for this record, use the assignment
+                for(uint8_t i = 0; i < rec->length; i++) {
+                    if(CMD_CALC == rec->assign[i].div)
+                        continue;
+                    if((rec->assign[i].start + rec->assign[i].num) > len)
+                        len = rec->assign[i].start + rec->assign[i].num;
+                }
+            }
+            if((0 == len) || ((len + 2) > (MAX_PAYLOAD_ENTRIES * SIM_RADIO_FRAG_LEN)))
+                return 0;
+
+            memset(pyld, 0, len);
+            for(uint8_t i = 0; i < rec->length; i++) {
+                byteAssign_t *a = &rec->assign[i];
+                if((CMD_CALC == a->div) || ((a->start + a->num) > len))
+                    continue;
+                uint32_t val = getValue(a, ts);
+                for(uint8_t j = a->num; j > 0; j--) {
+                    pyld[a->start + j - 1] = val & 0xff;
+                    val >>= 8;
+                }
+            }
+
+            uint16_t crc = ah::crc16(pyld, len);
+            pyld[len++] = (crc >> 8) & 0xff;
+            pyld[len++] = (crc     ) & 0xff;
+            return len;
+        }
+
+        uint32_t getValue(byteAssign_t *a, uint32_t ts) {
+            switch(a->fieldId) {
+                case FLD_FW_VERSION:           return 10012;       // 1.0.12
+                case FLD_ACT_ACTIVE_PWR_LIMIT: return 100 * a->div; // 100%
+                case FLD_EVT:                  return 0;           // no alarms
+                default: break;
+            }
+            return ((ts / 60 + a->fieldId * 37 + a->ch * 11) % 200) * a->div;
+        }
+
+        void putOnAir(Inverter<> *iv, uint8_t mid, uint8_t pid, uint8_t data[], uint8_t len, bool last) {
+            simMedium_t *m = &mMedium[mRxChIdx];
+            uint32_t due = mAirDue;
+            mAirDue += SIM_RADIO_FRAG_MS;
+            if(random(100) < m->loss)
+                return;
+
+            simFrame_t *f = mAir.reserve();
+            if(NULL == f)
+                return;
+            packet_t *p = &f->pkt;
+            p->ch = mRfChLst[mRxChIdx];
+            p->packet[0] = mid + ALL_FRAMES;
+            p->packet[1] = iv->config->serial.b[3];
+            p->packet[2] = iv->config->serial.b[2];
+            p->packet[3] = iv->config->serial.b[1];
+            p->packet[4] = iv->config->serial.b[0];
+            memcpy(&p->packet[5], &mTxBuf[5], 4); // DTU id
+            p->packet[9] = pid;
+            memcpy(&p->packet[10], data, len);
+            p->len = 10 + len;
+            p->packet[p->len] = ah::crc8(p->packet, p->len);
+            p->len++;
+            f->due  = due;
+            f->last = last;
+            mAir.commit();
+
+            if(random(100) < m->dup) {
+                simFrame_t *d = mAir.reserve();
+                if(NULL != d) {
+                    *d = *f;
+                    d->last = false;
+                    mAir.commit();
+                }
+            }
+        }
+
+        void clearAir(void) {
+            while(!mAir.empty())
+                mAir.pop();
+        }
+
+        uint8_t mRxState;
+        uint32_t mRxStartMillis;
+        uint32_t mAirDue;
+        Inverter<> *mTxIv;
+
+        uint8_t mRfChLst[RF_CHANNELS];
+        uint8_t mTxChIdx;
+        uint8_t mRxChIdx;
+        simMedium_t mMedium[RF_CHANNELS];
+        ah::SpscRing<simFrame_t, SIM_RADIO_AIR_SIZE> mAir;
+
+        uint8_t mLastCmd[MAX_NUM_INVERTERS];
+        uint32_t mLastTs[MAX_NUM_INVERTERS];
+};
+
+#endif /*__SIM_RADIO_H__*/
@@ -15,6 +15,12 @@ IRAM_ATTR void handleIntr(void) {
     myApp.handleIntr();
 }
 
+#if defined(ENABLE_RX_RADIO)
+IRAM_ATTR void handleIntr2(void) {
+    myApp.handleIntr2();
+}
+#endif
+
 
 //-----------------------------------------------------------------------------
 void setup() {
@@ -22,6 +28,10 @@ void setup() {
 
     // TODO: move to HmRadio
     attachInterrupt(digitalPinToInterrupt(myApp.getIrqPin()), handleIntr, FALLING);
+    #if defined(ENABLE_RX_RADIO)
+    if(DEF_PIN_OFF != myApp.getIrqPin2())
+        attachInterrupt(digitalPinToInterrupt(myApp.getIrqPin2()), handleIntr2, FALLING);
+    #endif
 }
 
 
@@ -37,8 +37,17 @@ class Display {
             }
         }
 
-        void payloadEventListener(uint8_t cmd) {
-            mNewPayload = true;
+        // redraw only if one of the shown totals changed
+        void payloadEventListener(uint8_t cmd, Inverter<> *iv) {
+            if(RealTimeRunData_Debug != cmd)
+                return;
+            record_t<> *rec = iv->getRecordStruct(cmd);
+            const uint8_t shown[] = {FLD_PAC, FLD_YD, FLD_YT};
+            for(uint8_t i = 0; i < 3; i++) {
+                uint8_t pos = iv->getPosByChFld(CH0, shown[i], rec);
+                if((0xff != pos) && (rec->dirty & (1ULL << pos)))
+                    mNewPayload = true;
+            }
         }
 
         void tickerSecond() {
@@ -74,9 +83,9 @@ class Display {
                 if (iv->isProducing(*mUtcTs))
                     isprod++;
 
-                totalPower += iv->getChannelFieldValue(CH0, FLD_PAC, rec);
-                totalYieldDay += iv->getChannelFieldValue(CH0, FLD_YD, rec);
-                totalYieldTotal += iv->getChannelFieldValue(CH0, FLD_YT, rec);
+                totalPower += ah::toFloat(iv->getChannelFieldValue(CH0, FLD_PAC, rec));
+                totalYieldDay += ah::toFloat(iv->getChannelFieldValue(CH0, FLD_YD, rec));
+                totalYieldTotal += ah::toFloat(iv->getChannelFieldValue(CH0, FLD_YT, rec));
             }
 
             if ((0 < mCfg->type) && (mCfg->type < 10)) {
@@ -50,6 +50,7 @@ class PubMqtt {
             mSubscriptionCb = NULL;
             memset(mLastIvState, MQTT_STATUS_NOT_AVAIL_NOT_PROD, MAX_NUM_INVERTERS);
             memset(mIvLastRTRpub, 0, MAX_NUM_INVERTERS * 4);
+            memset(mDirty, 0xff, MAX_NUM_INVERTERS * 8);
             mLastAnyAvail = false;
         }
 
@@ -126,6 +127,7 @@ class PubMqtt {
             #ifndef ESP32
             publish(subtopics[MQTT_HEAP_FRAG], String(ESP.getHeapFragmentation()).c_str());
             #endif
+            sendRadioLatency();
         }
 
         bool tickerSun(uint32_t sunrise, uint32_t sunset, uint32_t offs, bool disNightCom) {
@@ -158,7 +160,9 @@ class PubMqtt {
             publish(mSubTopic, mVal, true);
         }
 
-        void payloadEventListener(uint8_t cmd) {
+        void payloadEventListener(uint8_t cmd, Inverter<> *iv) {
+            if(RealTimeRunData_Debug == cmd)
+                mDirty[iv->id] |= iv->getRecordStruct(cmd)->dirty;
             if(mClient.connected()) { // prevent overflow if MQTT broker is not reachable but set
                 if((0 == mCfgMqtt->interval) || (RealTimeRunData_Debug != cmd)) // no interval or no live data
                     mSendList.push(cmd);
@@ -251,6 +255,9 @@ class PubMqtt {
                 subscribe(mVal);
             }
             subscribe(subscr[MQTT_SUBS_SET_TIME]);
+
+            // the broker may have lost the retained values
+            memset(mDirty, 0xff, MAX_NUM_INVERTERS * 8);
         }
 
         void onDisconnect(espMqttClientTypes::DisconnectReason reason) {
@@ -522,6 +529,29 @@ class PubMqtt {
             }
         }
 
+        // summary of the latency histograms, the percentile is the upper bound of its bucket
+        void sendRadioLatency(void) {
+            char buf[140];
+            Inverter<> *iv;
+            for (uint8_t id = 0; id < mSys->getNumInverters(); id++) {
+                iv = mSys->getInverterByPos(id);
+                if (NULL == iv)
+                    continue;
+                for (uint8_t c = 0; c < RF_LAT_CMDS; c++) {
+                    rfLatency_t *lat = &iv->rfLat[c];
+                    uint32_t cnt = lat->payload.count();
+                    if (0 == cnt)
+                        continue;
+                    snprintf(mSubTopic, 32 + MAX_NAME_LENGTH, "%s/radio/%s", iv->config->name, rfLatCmdNames[c]);
+                    snprintf(buf, sizeof(buf), "{\"cnt\":%u,\"first_ms\":%u,\"last_ms\":%u,\"payload_ms\":%u,\"payload_p90_ms\":%u,\"retransmits\":%.2f}",
+                        cnt, lat->first.mean(), lat->last.mean(), lat->payload.mean(), lat->payload.percentile(90, rfLatBounds),
+                        (float)lat->retransmits.sum / (float)lat->retransmits.count());
+                    publish(mSubTopic, buf);
+                    yield();
+                }
+            }
+        }
+
         void sendData(Inverter<> *iv, uint8_t curInfoCmd) {
             record_t<> *rec = iv->getRecordStruct(curInfoCmd);
 
@@ -535,6 +565,8 @@ class PubMqtt {
                 for (uint8_t i = 0; i < rec->length; i++) {
                     bool retained = false;
                     if (curInfoCmd == RealTimeRunData_Debug) {
+                        if (!(mDirty[iv->id] & (1ULL << i)))
+                            continue; // unchanged since the last publish
                         switch (rec->assign[i].fieldId) {
                             case FLD_YT:
                             case FLD_YD:
@@ -546,11 +578,13 @@ class PubMqtt {
                     }
 
                     snprintf(mSubTopic, 32 + MAX_NAME_LENGTH, "%s/ch%d/%s", iv->config->name, rec->assign[i].ch, fields[rec->assign[i].fieldId]);
-                    snprintf(mVal, 40, "%g", ah::round3(iv->getValue(i, rec)));
+                    ah::fmtValue(mVal, 40, iv->getValue(i, rec));
                     publish(mSubTopic, mVal, retained);
 
                     yield();
                 }
+                if (curInfoCmd == RealTimeRunData_Debug)
+                    mDirty[iv->id] = 0;
             }
         }
 
@@ -562,11 +596,12 @@ class PubMqtt {
             if(mSendList.empty())
                 return;
 
-            float total[4];
+            recVal_t total[4];
             bool RTRDataHasBeenSent = false;
 
             while(!mSendList.empty()) {
-                memset(total, 0, sizeof(float) * 4);
+                for (uint8_t i = 0; i < 4; i++)
+                    total[i] = 0;
                 uint8_t curInfoCmd = mSendList.front();
 
                 if ((curInfoCmd != RealTimeRunData_Debug) || !RTRDataHasBeenSent) { // send RTR Data only once
@@ -634,7 +669,7 @@ class PubMqtt {
                                     break;
                             }
                             snprintf(mSubTopic, 32 + MAX_NAME_LENGTH, "total/%s", fields[fieldId]);
-                            snprintf(mVal, 40, "%g", ah::round3(total[i]));
+                            ah::fmtValue(mVal, 40, total[i]);
                             publish(mSubTopic, mVal, retained);
                         }
                         RTRDataHasBeenSent = true;
@@ -663,6 +698,7 @@ class PubMqtt {
         bool mLastAnyAvail;
         uint8_t mLastIvState[MAX_NUM_INVERTERS];
         uint32_t mIvLastRTRpub[MAX_NUM_INVERTERS];
+        uint64_t mDirty[MAX_NUM_INVERTERS]; // live data fields changed since the last publish
         uint16_t mIntervalTimeout;
 
         // last will topic and payload must be available trough lifetime of 'espMqttClient'
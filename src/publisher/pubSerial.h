@@ -31,9 +31,10 @@ class PubSerial {
                         if (iv->isAvailable(*mUtcTimestamp)) {
                             DPRINTLN(DBG_INFO, "Iv: " + String(id));
                             for (uint8_t i = 0; i < rec->length; i++) {
-                                if (0.0f != iv->getValue(i, rec)) {
+                                if (0 != iv->getValue(i, rec)) {
                                     snprintf(topic, 32 + MAX_NAME_LENGTH, "%s/ch%d/%s", iv->config->name, rec->assign[i].ch, iv->getFieldName(i, rec));
-                                    snprintf(val, 40, "%.3f %s", iv->getValue(i, rec), iv->getUnit(i, rec));
+                                    ah::fmtValue3(val, 20, iv->getValue(i, rec));
+                                    snprintf(&val[strlen(val)], 40 - strlen(val), " %s", iv->getUnit(i, rec));
                                     DPRINTLN(DBG_INFO, String(topic) + ": " + String(val));
                                 }
                                 yield();
@@ -14,6 +14,19 @@
 
 #define CRC16_MODBUS_POLYNOM    0xA001
 
+// implementation, can be set by a build flag
+#define CRC_IMPL_BITWISE        0   // eight shift / xor steps per byte
+#define CRC_IMPL_TABLE          1   // one lookup per byte, 512 byte table in flash
+#define CRC_IMPL_SLICE4         2   // four bytes per step, 2kB table
+
+#ifndef CRC_IMPL
+    #if defined(ESP32)
+        #define CRC_IMPL        CRC_IMPL_SLICE4
+    #else
+        #define CRC_IMPL        CRC_IMPL_TABLE
+    #endif
+#endif
+
 namespace ah {
     uint8_t crc8(uint8_t buf[], uint8_t len);
     uint16_t crc16(uint8_t buf[], uint8_t len, uint16_t start = 0xffff);
@@ -0,0 +1,163 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __FIXED_POINT_H__
+#define __FIXED_POINT_H__
+
+#include <Arduino.h>
+#include <cstdint>
+#include <math.h>
+#include <stdio.h>
+
+#define FIXED_SCALE     1000 // 3 decimals, all divisors of the assignment tables divide it
+
+namespace ah {
+    double round3(double value);
+
+    // value with 3 decimals stored as integer (range +-2147483.647),
+    // calculations and formatting work without floating point. The decoded
+    // values are exact if the divisor of the assignment divides FIXED_SCALE.
+    class Fixed {
+        public:
+            Fixed() : mRaw(0) {}
+            Fixed(int v) : mRaw((int32_t)v * FIXED_SCALE) {}
+            Fixed(unsigned int v) : mRaw((int32_t)v * FIXED_SCALE) {}
+            Fixed(long v) : mRaw((int32_t)v * FIXED_SCALE) {}
+            Fixed(unsigned long v) : mRaw((int32_t)v * FIXED_SCALE) {}
+            Fixed(float v) : mRaw((int32_t)lroundf(v * FIXED_SCALE)) {}
+            Fixed(double v) : mRaw((int32_t)lround(v * FIXED_SCALE)) {}
+
+            static Fixed fromRaw(int32_t raw) {
+                Fixed f;
+                f.mRaw = raw;
+                return f;
+            }
+
+            // val / div
+            static Fixed scaled(int32_t val, uint16_t div) {
+                if((0 != div) && (0 == (FIXED_SCALE % div)))
+                    return fromRaw(val * (int32_t)(FIXED_SCALE / div));
+                return fromRaw((int32_t)(((int64_t)val * FIXED_SCALE) / div));
+            }
+
+            inline int32_t raw(void) const {
+                return mRaw;
+            }
+
+            float toFloat(void) const {
+                return (float)mRaw / FIXED_SCALE;
+            }
+
+            // integer part
+            explicit operator int32_t() const {
+                return mRaw / FIXED_SCALE;
+            }
+
+            Fixed &operator+=(const Fixed &o) { mRaw += o.mRaw; return *this; }
+            Fixed &operator-=(const Fixed &o) { mRaw -= o.mRaw; return *this; }
+
+            friend Fixed operator+(Fixed a, const Fixed &b) { return a += b; }
+            friend Fixed operator-(Fixed a, const Fixed &b) { return a -= b; }
+            friend Fixed operator*(const Fixed &a, const Fixed &b) {
+                return fromRaw((int32_t)(((int64_t)a.mRaw * b.mRaw) / FIXED_SCALE));
+            }
+            friend Fixed operator/(const Fixed &a, const Fixed &b) {
+                if(0 == b.mRaw)
+                    return Fixed();
+                return fromRaw((int32_t)(((int64_t)a.mRaw * FIXED_SCALE) / b.mRaw));
+            }
+
+            friend bool operator==(const Fixed &a, const Fixed &b) { return a.mRaw == b.mRaw; }
+            friend bool operator!=(const Fixed &a, const Fixed &b) { return a.mRaw != b.mRaw; }
+            friend bool operator< (const Fixed &a, const Fixed &b) { return a.mRaw <  b.mRaw; }
+            friend bool operator> (const Fixed &a, const Fixed &b) { return a.mRaw >  b.mRaw; }
+            friend bool operator<=(const Fixed &a, const Fixed &b) { return a.mRaw <= b.mRaw; }
+            friend bool operator>=(const Fixed &a, const Fixed &b) { return a.mRaw >= b.mRaw; }
+
+        private:
+            int32_t mRaw;
+    };
+
+    // val / div in the record value type, the float variant calculates like
+    // the assignment interpreter always did
+    template <class T>
+    inline T scaleValue(int32_t val, uint16_t div) {
+        return ((T)(div) > 1) ? ((T)(val) / (T)(div)) : (T)(val);
+    }
+
+    template <class T>
+    inline T scaleValue(uint32_t val, uint16_t div) {
+        return ((T)(div) > 1) ? ((T)(val) / (T)(div)) : (T)(val);
+    }
+
+    template <>
+    inline Fixed scaleValue<Fixed>(int32_t val, uint16_t div) {
+        return Fixed::scaled(val, div);
+    }
+
+    template <>
+    inline Fixed scaleValue<Fixed>(uint32_t val, uint16_t div) {
+        return Fixed::scaled((int32_t)val, div);
+    }
+
+    inline float toFloat(float v) {
+        return v;
+    }
+
+    inline float toFloat(const Fixed &v) {
+        return v.toFloat();
+    }
+
+    inline int32_t toInt(float v) {
+        return (int32_t)v;
+    }
+
+    inline int32_t toInt(const Fixed &v) {
+        return (int32_t)v;
+    }
+
+    // absolute value in 1/1000
+    inline uint32_t absMilli(float v) {
+        return (uint32_t)lroundf(fabsf(v) * FIXED_SCALE);
+    }
+
+    inline uint32_t absMilli(const Fixed &v) {
+        int32_t raw = v.raw();
+        return (raw < 0) ? -raw : raw;
+    }
+
+    // shortest representation, up to 3 decimals
+    inline void fmtValue(char *buf, uint8_t len, float v) {
+        snprintf(buf, len, "%g", round3(v));
+    }
+
+    inline void fmtValue(char *buf, uint8_t len, const Fixed &v) {
+        int32_t raw  = v.raw();
+        uint32_t abs = (raw < 0) ? -raw : raw;
+        uint32_t frac = abs % FIXED_SCALE;
+        const char *sign = (raw < 0) ? "-" : "";
+        if(0 == frac)
+            snprintf(buf, len, "%s%u", sign, abs / FIXED_SCALE);
+        else if(0 == (frac % 100))
+            snprintf(buf, len, "%s%u.%01u", sign, abs / FIXED_SCALE, frac / 100);
+        else if(0 == (frac % 10))
+            snprintf(buf, len, "%s%u.%02u", sign, abs / FIXED_SCALE, frac / 10);
+        else
+            snprintf(buf, len, "%s%u.%03u", sign, abs / FIXED_SCALE, frac);
+    }
+
+    // always 3 decimals
+    inline void fmtValue3(char *buf, uint8_t len, float v) {
+        snprintf(buf, len, "%.3f", v);
+    }
+
+    inline void fmtValue3(char *buf, uint8_t len, const Fixed &v) {
+        int32_t raw  = v.raw();
+        uint32_t abs = (raw < 0) ? -raw : raw;
+        snprintf(buf, len, "%s%u.%03u", (raw < 0) ? "-" : "", abs / FIXED_SCALE, abs % FIXED_SCALE);
+    }
+}
+
+#endif /*__FIXED_POINT_H__*/
@@ -0,0 +1,63 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HISTOGRAM_H__
+#define __HISTOGRAM_H__
+
+#include <cstdint>
+#include <cstring>
+
+namespace ah {
+    // fixed bucket histogram, bucket i counts the values <= bounds[i], the
+    // last bucket all larger values (+Inf). The bounds are not stored to keep
+    // many histograms small. Counters stop at 0xffff instead of wrapping.
+    template <uint8_t N>
+    struct Histogram {
+        uint16_t bucket[N];
+        uint32_t sum;
+
+        void clear(void) {
+            memset(bucket, 0, sizeof(bucket));
+            sum = 0;
+        }
+
+        void add(uint32_t val, const uint16_t bounds[]) {
+            uint8_t i = 0;
+            while((i < (N - 1)) && (val > bounds[i]))
+                i++;
+            if(0xffff == bucket[i])
+                return;
+            bucket[i]++;
+            sum += val;
+        }
+
+        uint32_t count(void) const {
+            uint32_t cnt = 0;
+            for(uint8_t i = 0; i < N; i++)
+                cnt += bucket[i];
+            return cnt;
+        }
+
+        uint32_t mean(void) const {
+            uint32_t cnt = count();
+            return (0 == cnt) ? 0 : (sum / cnt);
+        }
+
+        // upper bound of the bucket which contains the given percentile,
+        // 0xffff if it is the +Inf bucket
+        uint16_t percentile(uint8_t pct, const uint16_t bounds[]) const {
+            uint32_t limit = (count() * pct + 99) / 100;
+            uint32_t cnt = 0;
+            for(uint8_t i = 0; i < (N - 1); i++) {
+                cnt += bucket[i];
+                if(cnt >= limit)
+                    return bounds[i];
+            }
+            return 0xffff;
+        }
+    };
+}
+
+#endif /*__HISTOGRAM_H__*/
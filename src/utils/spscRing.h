@@ -0,0 +1,101 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __SPSC_RING_H__
+#define __SPSC_RING_H__
+
+#include <cstdint>
+#include <cstddef>
+
+namespace ah {
+    // fixed size single producer / single consumer ring buffer
+    // the producer only writes mHead, the consumer only writes mTail, so no
+    // locking is required as long as both sides stay on their own end. The
+    // producer side does not allocate and can be called from an ISR.
+    template <class T, uint8_t SIZE>
+    class SpscRing {
+        // indices, size() and the high water mark are uint8_t and have to
+        // reach SIZE + 1
+        static_assert(SIZE < 255, "SpscRing holds at most 254 elements");
+
+        public:
+            SpscRing() : mHead(0), mTail(0), mOverflow(0), mHighWater(0) {}
+
+            // producer: returns the next free slot or NULL if the ring is full
+            // the slot is published with commit()
+            T *reserve(void) {
+                if(next(mHead) == mTail) {
+                    mOverflow++;
+                    return NULL;
+                }
+                return &mBuf[mHead];
+            }
+
+            void commit(void) {
+                mHead = next(mHead);
+                uint8_t fill = size();
+                if(fill > mHighWater)
+                    mHighWater = fill;
+            }
+
+            bool push(const T &v) {
+                T *slot = reserve();
+                if(NULL == slot)
+                    return false;
+                *slot = v;
+                commit();
+                return true;
+            }
+
+            // consumer: returns the oldest element or NULL if the ring is empty
+            // the element stays valid until pop() is called
+            T *peek(void) {
+                if(empty())
+                    return NULL;
+                return &mBuf[mTail];
+            }
+
+            void pop(void) {
+                if(!empty())
+                    mTail = next(mTail);
+            }
+
+            bool empty(void) const {
+                return (mHead == mTail);
+            }
+
+            uint8_t size(void) const {
+                uint8_t head = mHead;
+                uint8_t tail = mTail;
+                return (head >= tail) ? (head - tail) : (SIZE + 1 - tail + head);
+            }
+
+            uint8_t capacity(void) const {
+                return SIZE;
+            }
+
+            uint32_t getOverflowCnt(void) const {
+                return mOverflow;
+            }
+
+            uint8_t getHighWater(void) const {
+                return mHighWater;
+            }
+
+        private:
+            inline uint8_t next(uint8_t idx) const {
+                return (idx >= SIZE) ? 0 : (idx + 1);
+            }
+
+            // one slot stays unused to distinguish 'full' from 'empty'
+            T mBuf[SIZE + 1];
+            volatile uint8_t mHead;
+            volatile uint8_t mTail;
+            volatile uint32_t mOverflow;
+            volatile uint8_t mHighWater;
+    };
+}
+
+#endif /*__SPSC_RING_H__*/
@@ -47,6 +47,7 @@ class RestApi {
                                         std::bind(&RestApi::onApiPostBody, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4, std::placeholders::_5));
 
             mSrv->on("/get_setup", HTTP_GET,  std::bind(&RestApi::onDwnldSetup, this, std::placeholders::_1));
+            mSrv->on("/get_capture", HTTP_GET, std::bind(&RestApi::onDwnldCapture, this, std::placeholders::_1));
         }
 
         uint32_t getTimezoneOffset(void) {
@@ -85,6 +86,7 @@ class RestApi {
             else if(path == "generic")        getGeneric(request, root);
             else if(path == "reboot")         getReboot(request, root);
             else if(path == "statistics")     getStatistics(root);
+            else if(path == "radio/channels") getRadioChannels(root);
             else if(path == "inverter/list")  getInverterList(root);
             else if(path == "index")          getIndex(request, root);
             else if(path == "setup")          getSetup(request, root);
@@ -189,6 +191,16 @@ class RestApi {
             fp.close();
         }
 
+        void onDwnldCapture(AsyncWebServerRequest *request) {
+            // the radio loop writes the staged records, at most CAPTURE_FLUSH_MS old
+            if(!LittleFS.exists(CAPTURE_FILE)) {
+                request->send(404, F("text/plain"), F("no capture"));
+                return;
+            }
+            AsyncWebServerResponse *response = request->beginResponse(LittleFS, CAPTURE_FILE, F("application/octet-stream"), true);
+            request->send(response);
+        }
+
         void getGeneric(AsyncWebServerRequest *request, JsonObject obj) {
             obj[F("wifi_rssi")]   = (WiFi.status() != WL_CONNECTED) ? 0 : WiFi.RSSI();
             obj[F("ts_uptime")]   = mApp->getUptime();
@@ -292,8 +304,110 @@ class RestApi {
             obj[F("rx_fail")]        = stat->rxFail;
             obj[F("rx_fail_answer")] = stat->rxFailNoAnser;
             obj[F("frame_cnt")]      = stat->frmCnt;
+            obj[F("frame_dup")]      = stat->frmDup;
+            obj[F("rx_buf_overflow")]   = stat->rxBufOverflow;
+            obj[F("rx_buf_high_water")] = stat->rxBufHighWater;
             obj[F("tx_cnt")]         = mSys->Radio.mSendCnt;
             obj[F("retransmits")]    = mSys->Radio.mRetransmits;
+            obj[F("capture_en")]      = mSys->Capture.isEnabled();
+            obj[F("capture_records")] = mSys->Capture.getCount();
+            obj[F("capture_lost")]    = mSys->Capture.getLostCnt();
+
+            // latency histograms, only request classes which were answered at least once
+            for(uint8_t i = 0; i < (RF_LAT_BUCKETS - 1); i++)
+                obj[F("latency_bounds_ms")][i] = rfLatBounds[i];
+            for(uint8_t i = 0; i < (RF_RETR_BUCKETS - 1); i++)
+                obj[F("retransmit_bounds")][i] = rfRetrBounds[i];
+            JsonArray latArr = obj.createNestedArray(F("latency"));
+            Inverter<> *iv;
+            for(uint8_t i = 0; i < MAX_NUM_INVERTERS; i ++) {
+                iv = mSys->getInverterByPos(i);
+                if(NULL == iv)
+                    continue;
+                for(uint8_t c = 0; c < RF_LAT_CMDS; c++) {
+                    rfLatency_t *lat = &iv->rfLat[c];
+                    if(0 == lat->first.count())
+                        continue;
+                    JsonObject obj2 = latArr.createNestedObject();
+                    obj2[F("id")]  = i;
+                    obj2[F("cmd")] = rfLatCmdNames[c];
+                    getHistogram(obj2.createNestedObject(F("first_ms")),    lat->first);
+                    getHistogram(obj2.createNestedObject(F("last_ms")),     lat->last);
+                    getHistogram(obj2.createNestedObject(F("payload_ms")),  lat->payload);
+                    getHistogram(obj2.createNestedObject(F("retransmits")), lat->retransmits);
+                }
+            }
+        }
+
+        // numbers with up to 3 decimals, fixed point values are not converted to float
+        void setJsonValue(JsonVariant dst, float val) {
+            dst.set(ah::round3(val));
+        }
+
+        void setJsonValue(JsonVariant dst, const ah::Fixed &val) {
+            char buf[16];
+            ah::fmtValue(buf, sizeof(buf), val);
+            dst.set(serialized(String(buf)));
+        }
+
+        String valueStr(float val) {
+            return String(val);
+        }
+
+        String valueStr(const ah::Fixed &val) {
+            char buf[16];
+            ah::fmtValue3(buf, sizeof(buf), val);
+            return String(buf);
+        }
+
+        template <uint8_t N>
+        void getHistogram(JsonObject obj, const ah::Histogram<N> &hist) {
+            for(uint8_t i = 0; i < N; i++)
+                obj[F("buckets")][i] = hist.bucket[i];
+            obj[F("sum")] = hist.sum;
+        }
+
+        void getRadioChannels(JsonObject obj) {
+            for(uint8_t ch = 0; ch < RF_CHANNELS; ch++)
+                obj[F("channels")][ch] = mSys->Radio.getRfChannel(ch);
+            for(uint8_t i = 0; i < (REFRESH_BUCKETS - 1); i++)
+                obj[F("refresh_bounds_s")][i] = refreshAgeBounds[i];
+
+            JsonArray invArr = obj.createNestedArray(F("inverter"));
+            Inverter<> *iv;
+            for(uint8_t i = 0; i < MAX_NUM_INVERTERS; i ++) {
+                iv = mSys->getInverterByPos(i);
+                if(NULL != iv) {
+                    JsonObject obj2 = invArr.createNestedObject();
+                    obj2[F("id")]   = i;
+                    obj2[F("name")] = String(iv->config->name);
+                    obj2[F("rx_delay_us")] = iv->rfModel.delay;
+                    obj2[F("dup_frames")]  = iv->rfDup.dupCnt;
+                    obj2[F("refresh_age_s")]   = iv->getRefreshAge();
+                    obj2[F("refresh_backoff")] = iv->refresh.backoff;
+                    obj2[F("retransmit_budget")] = iv->rfRetr.budget;
+                    obj2[F("cmd_queue")]            = iv->cmdQueue.size();
+                    obj2[F("cmd_queue_high_water")] = iv->cmdQueue.getHighWater();
+                    obj2[F("cmd_queue_dup")]        = iv->cmdQueue.getDupCnt();
+                    obj2[F("cmd_queue_overflow")]   = iv->cmdQueue.getOverflowCnt();
+                    obj2[F("cmd_queue_wait_max_ms")] = iv->cmdQueue.getMaxWaitMs();
+                    getHistogram(obj2.createNestedObject(F("refresh_s")), iv->refresh.age);
+                    if(RF_PA_UNSET != iv->rfPa.level)
+                        obj2[F("pa_level")] = String(rf24AmpPowerNames[iv->rfPa.level & 0x03]);
+                    for(uint8_t ch = 0; ch < RF_CHANNELS; ch++) {
+                        obj2[F("rx_offset_hits")][ch] = iv->rfModel.offsetHits[ch];
+                        obj2[F("frames")][ch]     = iv->rfStat[ch].frames;
+                        obj2[F("crc_fail")][ch]   = iv->rfStat[ch].crcFail;
+                        obj2[F("ttff_us")][ch]    = iv->rfStat[ch].ttff;
+                        obj2[F("rx_quality")][ch] = iv->rfStat[ch].rxQuality;
+                        obj2[F("tx_quality")][ch] = iv->rfStat[ch].txQuality;
+                    }
+                    for(uint8_t c = 0; c < RF_LAT_CMDS; c++) {
+                        obj2[F("last_frag_us")][c] = iv->rfWin[c].lastUs;
+                        obj2[F("frag_span_us")][c] = iv->rfWin[c].spanUs;
+                    }
+                }
+            }
         }
 
         void getInverterList(JsonObject obj) {
@@ -346,7 +460,7 @@ class RestApi {
                 JsonArray ch0 = ch.createNestedArray();
                 for (uint8_t fld = 0; fld < sizeof(acList); fld++) {
                     pos = (iv->getPosByChFld(CH0, acList[fld], rec));
-                    ch0[fld] = (0xff != pos) ? ah::round3(iv->getValue(pos, rec)) : 0.0;
+                    setJsonValue(ch0.add(), (0xff != pos) ? iv->getValue(pos, rec) : (recVal_t)0);
                 }
 
                 // DC
@@ -356,7 +470,7 @@ class RestApi {
                     JsonArray cur = ch.createNestedArray();
                     for (uint8_t fld = 0; fld < sizeof(dcList); fld++) {
                         pos = (iv->getPosByChFld((j+1), dcList[fld], rec));
-                        cur[fld] = (0xff != pos) ? ah::round3(iv->getValue(pos, rec)) : 0.0;
+                        setJsonValue(cur.add(), (0xff != pos) ? iv->getValue(pos, rec) : (recVal_t)0);
                     }
                 }
             }
@@ -390,6 +504,9 @@ class RestApi {
             obj[F("sclk")] = mConfig->nrf.pinSclk;
             obj[F("mosi")] = mConfig->nrf.pinMosi;
             obj[F("miso")] = mConfig->nrf.pinMiso;
+            obj[F("cs2")]  = mConfig->nrf.pinCs2;
+            obj[F("ce2")]  = mConfig->nrf.pinCe2;
+            obj[F("irq2")] = mConfig->nrf.pinIrq2;
             obj[F("led0")] = mConfig->led.led0;
             obj[F("led1")] = mConfig->led.led1;
             obj[F("led_high_active")] = mConfig->led.led_high_active;
@@ -537,7 +654,7 @@ class RestApi {
                         pos = (iv->getPosByChFld(assign->ch, assign->fieldId, rec));
                         obj2[j]["fld"]  = (0xff != pos) ? String(iv->getFieldName(pos, rec)) : notAvail;
                         obj2[j]["unit"] = (0xff != pos) ? String(iv->getUnit(pos, rec)) : notAvail;
-                        obj2[j]["val"]  = (0xff != pos) ? String(iv->getValue(pos, rec)) : notAvail;
+                        obj2[j]["val"]  = (0xff != pos) ? valueStr(iv->getValue(pos, rec)) : notAvail;
                     }
                 }
             }
@@ -570,7 +687,7 @@ class RestApi {
             }
             else if(F("dev") == jsonIn[F("cmd")]) {
                 DPRINTLN(DBG_INFO, F("dev cmd"));
-                iv->enqueCommand<InfoCommand>(jsonIn[F("val")].as<int>());
+                iv->enqueCommand(jsonIn[F("val")].as<int>());
             }
             else {
                 jsonOut[F("error")] = F("unknown cmd: '") + jsonIn["cmd"].as<String>() + "'";
@@ -597,7 +714,11 @@ class RestApi {
                 mTimezoneOffset = jsonIn[F("val")];
             else if(F("discovery_cfg") == jsonIn[F("cmd")]) {
                 mApp->setMqttDiscoveryFlag(); // for homeassistant
-            } else {
+            } else if(F("capture") == jsonIn[F("cmd")])
+                mApp->setCaptureEnable(jsonIn[F("val")] == 1);
+            else if(F("capture_clear") == jsonIn[F("cmd")])
+                mApp->clearCapture();
+            else {
                 jsonOut[F("error")] = F("unknown cmd");
                 return false;
             }
@@ -34,7 +34,7 @@
 
 #define WEB_SERIAL_BUF_SIZE 2048
 
-const char *const pinArgNames[] = {"pinCs", "pinCe", "pinIrq", "pinSclk", "pinMosi", "pinMiso", "pinLed0", "pinLed1", "pinLedHighActive"};
+const char *const pinArgNames[] = {"pinCs", "pinCe", "pinIrq", "pinSclk", "pinMosi", "pinMiso", "pinLed0", "pinLed1", "pinLedHighActive", "pinCs2", "pinCe2", "pinIrq2"};
 
 template <class HMSYSTEM>
 class Web {
@@ -502,6 +502,7 @@ class Web {
                     iv->config->chMaxPwr[j] = request->arg("inv" + String(i) + "ModPwr" + String(j)).toInt() & 0xffff;
                     request->arg("inv" + String(i) + "ModName" + String(j)).toCharArray(iv->config->chName[j], MAX_NAME_LENGTH);
                 }
+                iv->invalidateCalc(); // irradiation depends on chMaxPwr
                 iv->initialized = true;
             }
 
@@ -515,7 +516,9 @@ class Web {
 
             // pinout
             uint8_t pin;
-            for (uint8_t i = 0; i < 9; i++) {
+            for (uint8_t i = 0; i < 12; i++) {
+                if (request->arg(String(pinArgNames[i])) == "")
+                    continue; // not shown for this ESP type
                 pin = request->arg(String(pinArgNames[i])).toInt();
                 switch(i) {
                     default: mConfig->nrf.pinCs    = ((pin != 0xff) ? pin : DEF_CS_PIN);  break;
@@ -527,6 +530,9 @@ class Web {
                     case 6:  mConfig->led.led0 = pin; break;
                     case 7:  mConfig->led.led1 = pin; break;
                     case 8:  mConfig->led.led_high_active = pin; break;  // this is not really a pin but a polarity, but handling it close to here makes sense
+                    case 9:  mConfig->nrf.pinCs2   = pin; break;
+                    case 10: mConfig->nrf.pinCe2   = pin; break;
+                    case 11: mConfig->nrf.pinIrq2  = pin; break;
                 }
             }
 
@@ -628,14 +634,16 @@ class Web {
 
 #ifdef ENABLE_PROMETHEUS_EP
         enum {
-            metricsStateStart, metricsStateInverter, metricStateRealtimeData,metricsStateAlarmData,metricsStateEnd
+            metricsStateStart, metricsStateInverter, metricStateRealtimeData,metricsStateAlarmData,metricsStateRadioChannel,metricsStateLatency,metricsStateEnd
         } metricsStep;
         int metricsInverterId,metricsChannelId;
+        String metricsRest; // part of the last chunk which didn't fit into the buffer
 
         void showMetrics(AsyncWebServerRequest *request) {
             DPRINTLN(DBG_VERBOSE, F("web::showMetrics"));
 
             metricsStep = metricsStateStart;
+            metricsRest = "";
             AsyncWebServerResponse *response = request->beginChunkedResponse(F("text/plain"),
                                                                              [this](uint8_t *buffer, size_t maxLen, size_t filledLength) -> size_t
             {
@@ -648,6 +656,12 @@ class Web {
                 size_t len = 0;
                 int alarmChannelId;
 
+                if (0 != metricsRest.length()) { // finish the last chunk first
+                    metrics = metricsRest;
+                    metricsRest = "";
+                    return metricsChunk(buffer, maxLen, metrics);
+                }
+
                 switch (metricsStep) {
                     case metricsStateStart: // System Info & NRF Statistics : fit to one packet
                         snprintf(type,sizeof(type),"# TYPE ahoy_solar_info gauge\n");
@@ -673,9 +687,12 @@ class Web {
                         metrics += radioStatistic(F("rx_fail"),        stat->rxFail);
                         metrics += radioStatistic(F("rx_fail_answer"), stat->rxFailNoAnser);
                         metrics += radioStatistic(F("frame_cnt"),      stat->frmCnt);
+                        metrics += radioStatistic(F("frame_dup"),      stat->frmDup);
+                        metrics += radioStatistic(F("rx_buf_overflow"),   stat->rxBufOverflow);
+                        metrics += radioStatistic(F("rx_buf_high_water"), stat->rxBufHighWater);
                         metrics += radioStatistic(F("tx_cnt"),         mSys->Radio.mSendCnt);
 
-                        len = snprintf((char *)buffer,maxLen,"%s",metrics.c_str());
+                        len = metricsChunk(buffer, maxLen, metrics);
                         // Start Inverter loop
                         metricsInverterId = 0;
                         metricsStep = metricsStateInverter;
@@ -703,7 +720,7 @@ class Web {
                                 snprintf(topic,sizeof(topic),"ahoy_solar_inverter_is_producing {inverter=\"%s\"} %d\n",iv->config->name,iv->isProducing(mApp->getTimestamp()));
                                 metrics += String(type) + String(topic);
 
-                                len = snprintf((char *)buffer,maxLen,"%s",metrics.c_str());
+                                len = metricsChunk(buffer, maxLen, metrics);
 
                                 // Start Realtime Data Channel loop for this inverter
                                 metricsChannelId = 0;
@@ -728,7 +745,7 @@ class Web {
                                 } else {
                                     snprintf(topic, sizeof(topic), "ahoy_solar_%s%s{inverter=\"%s\",channel=\"%s\"}", iv->getFieldName(metricsChannelId, rec), promUnit.c_str(), iv->config->name,iv->config->chName[channel-1]);
                                 }
-                                snprintf(val, sizeof(val), "%.3f", iv->getValue(metricsChannelId, rec));
+                                ah::fmtValue3(val, sizeof(val), iv->getValue(metricsChannelId, rec));
                                 len = snprintf((char*)buffer,maxLen,"%s\n%s %s\n",type,topic,val);
                             } else {
                                 len = snprintf((char*)buffer,maxLen,"#\n"); // At least one char to send otherwise the transmission ends.
@@ -755,14 +772,61 @@ class Web {
                             std::tie(promUnit, promType) = convertToPromUnits(iv->getUnit(alarmChannelId, rec));
                             snprintf(type, sizeof(type), "# TYPE ahoy_solar_%s%s %s", iv->getFieldName(alarmChannelId, rec), promUnit.c_str(), promType.c_str());
                             snprintf(topic, sizeof(topic), "ahoy_solar_%s%s{inverter=\"%s\"}", iv->getFieldName(alarmChannelId, rec), promUnit.c_str(), iv->config->name);
-                            snprintf(val, sizeof(val), "%.3f", iv->getValue(alarmChannelId, rec));
+                            ah::fmtValue3(val, sizeof(val), iv->getValue(alarmChannelId, rec));
                             len = snprintf((char*)buffer,maxLen,"%s\n%s %s\n",type,topic,val);
                         } else {
                             len = snprintf((char*)buffer,maxLen,"#\n"); // At least one char to send otherwise the transmission ends.
                         }
-                        // alarm channel processed --> try next inverter
-                        metricsInverterId++;
-                        metricsStep = metricsStateInverter;
+                        // alarm channel processed --> radio channel statistics
+                        metricsChannelId = 0;
+                        metricsStep = metricsStateRadioChannel;
+                        break;
+
+                    case metricsStateRadioChannel: // Radio statistics per RF channel
+                        iv = mSys->getInverterByPos(metricsInverterId);
+                        if (metricsChannelId < RF_CHANNELS) {
+                            rfChStat_t *rfStat = &iv->rfStat[metricsChannelId];
+                            uint8_t rfCh = mSys->Radio.getRfChannel(metricsChannelId);
+                            metrics  = radioChStatistic(F("frames"),     F("counter"), iv->config->name, rfCh, rfStat->frames);
+                            metrics += radioChStatistic(F("crc_fail"),   F("counter"), iv->config->name, rfCh, rfStat->crcFail);
+                            metrics += radioChStatistic(F("ttff_us"),    F("gauge"),   iv->config->name, rfCh, rfStat->ttff);
+                            metrics += radioChStatistic(F("rx_quality"), F("gauge"),   iv->config->name, rfCh, rfStat->rxQuality);
+                            metrics += radioChStatistic(F("tx_quality"), F("gauge"),   iv->config->name, rfCh, rfStat->txQuality);
+                            len = metricsChunk(buffer, maxLen, metrics);
+                            metricsChannelId++;
+                        } else {
+                            len = snprintf((char*)buffer,maxLen,"#\n"); // At least one char to send otherwise the transmission ends.
+
+                            // all RF channels processed --> latency histograms
+                            metricsChannelId = 0;
+                            metricsStep = metricsStateLatency;
+                        }
+                        break;
+
+                    case metricsStateLatency: // Latency histograms, one histogram per packet
+                        iv = mSys->getInverterByPos(metricsInverterId);
+                        if (metricsChannelId < (RF_LAT_CMDS * 4)) {
+                            uint8_t cmd = metricsChannelId / 4;
+                            rfLatency_t *lat = &iv->rfLat[cmd];
+                            if (0 == lat->first.count())
+                                metrics = F("#\n"); // At least one char to send otherwise the transmission ends.
+                            else {
+                                switch (metricsChannelId % 4) {
+                                    case 0:  metrics = radioHistogram(F("latency_first_ms"),    iv->config->name, rfLatCmdNames[cmd], lat->first,       rfLatBounds); break;
+                                    case 1:  metrics = radioHistogram(F("latency_last_ms"),     iv->config->name, rfLatCmdNames[cmd], lat->last,        rfLatBounds); break;
+                                    case 2:  metrics = radioHistogram(F("latency_payload_ms"),  iv->config->name, rfLatCmdNames[cmd], lat->payload,     rfLatBounds); break;
+                                    default: metrics = radioHistogram(F("payload_retransmits"), iv->config->name, rfLatCmdNames[cmd], lat->retransmits, rfRetrBounds); break;
+                                }
+                            }
+                            len = metricsChunk(buffer, maxLen, metrics);
+                            metricsChannelId++;
+                        } else {
+                            len = snprintf((char*)buffer,maxLen,"#\n"); // At least one char to send otherwise the transmission ends.
+
+                            // all histograms processed --> try next inverter
+                            metricsInverterId++;
+                            metricsStep = metricsStateInverter;
+                        }
                         break;
 
                     case metricsStateEnd:
@@ -775,6 +839,17 @@ class Web {
             request->send(response);
         }
 
+        // copies as much of metrics as fits, the rest is sent with the next call
+        size_t metricsChunk(uint8_t *buffer, size_t maxLen, const String &metrics) {
+            size_t len = metrics.length();
+            if (len > maxLen) {
+                metricsRest = metrics.substring(maxLen);
+                len = maxLen;
+            }
+            memcpy(buffer, metrics.c_str(), len);
+            return len;
+        }
+
         String radioStatistic(String statistic, uint32_t value) {
             char type[60], topic[80], val[25];
             snprintf(type, sizeof(type), "# TYPE ahoy_solar_radio_%s counter",statistic.c_str());
@@ -783,6 +858,33 @@ class Web {
             return ( String(type) + "\n" + String(topic) + " " + String(val) + "\n");
         }
 
+        String radioChStatistic(String statistic, String promType, const char *ivName, uint8_t rfCh, uint32_t value) {
+            char type[70], topic[100];
+            snprintf(type, sizeof(type), "# TYPE ahoy_solar_radio_ch_%s %s", statistic.c_str(), promType.c_str());
+            snprintf(topic, sizeof(topic), "ahoy_solar_radio_ch_%s{inverter=\"%s\",rf_channel=\"%d\"} %u", statistic.c_str(), ivName, rfCh, value);
+            return (String(type) + "\n" + String(topic) + "\n");
+        }
+
+        template <uint8_t N>
+        String radioHistogram(String statistic, const char *ivName, const char *cmd, const ah::Histogram<N> &hist, const uint16_t bounds[]) {
+            char line[130];
+            uint32_t cnt = 0;
+            snprintf(line, sizeof(line), "# TYPE ahoy_solar_radio_%s histogram\n", statistic.c_str());
+            String metrics = String(line);
+            for(uint8_t i = 0; i < N; i++) {
+                cnt += hist.bucket[i];
+                if(i < (N - 1))
+                    snprintf(line, sizeof(line), "ahoy_solar_radio_%s_bucket{inverter=\"%s\",cmd=\"%s\",le=\"%u\"} %u\n", statistic.c_str(), ivName, cmd, bounds[i], cnt);
+                else
+                    snprintf(line, sizeof(line), "ahoy_solar_radio_%s_bucket{inverter=\"%s\",cmd=\"%s\",le=\"+Inf\"} %u\n", statistic.c_str(), ivName, cmd, cnt);
+                metrics += String(line);
+            }
+            snprintf(line, sizeof(line), "ahoy_solar_radio_%s_sum{inverter=\"%s\",cmd=\"%s\"} %u\n", statistic.c_str(), ivName, cmd, hist.sum);
+            metrics += String(line);
+            snprintf(line, sizeof(line), "ahoy_solar_radio_%s_count{inverter=\"%s\",cmd=\"%s\"} %u\n", statistic.c_str(), ivName, cmd, cnt);
+            return metrics + String(line);
+        }
+
         std::pair<String, String> convertToPromUnits(String shortUnit) {
             if(shortUnit == "A")    return {"_ampere", "gauge"};
             if(shortUnit == "V")    return {"_volt", "gauge"};
@@ -0,0 +1,117 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+// feeds random payloads to the generated decoders (assignDecoder::decode)
+// and to the table interpreter (assignDecoder::interpret) for all six
+// assignment tables and compares the decoded values, float and ah::Fixed
+//
+// usage: assignDecoderTest [-n payloads per table] [-s seed]
+
+#include <Arduino.h>
+#include <unistd.h>
+#include "hm/assignDecoder.h"
+
+#define MAX_REC_LEN     64
+
+// the part of record_t the decoders use
+template <class VAL>
+struct testRec_t {
+    typedef VAL value_type;
+
+    const byteAssign_t *assign;
+    uint8_t length;
+    VAL record[MAX_REC_LEN];
+
+    void set(uint8_t pos, const VAL &val) {
+        record[pos] = val;
+    }
+};
+
+typedef struct {
+    const char *name;
+    const byteAssign_t *assign;
+    uint8_t length;
+} table_t;
+
+static const table_t tables[] = {
+    {"hm1ch",            hm1chAssignment,            HM1CH_LIST_LEN},
+    {"hm2ch",            hm2chAssignment,            HM2CH_LIST_LEN},
+    {"hm4ch",            hm4chAssignment,            HM4CH_LIST_LEN},
+    {"Info",             InfoAssignment,             HMINFO_LIST_LEN},
+    {"SystemConfigPara", SystemConfigParaAssignment, HMSYSTEM_LIST_LEN},
+    {"AlarmData",        AlarmDataAssignment,        HMALARMDATA_LIST_LEN}
+};
+#define NUM_TABLES  (sizeof(tables) / sizeof(table_t))
+
+// returns the number of differing values
+template <class VAL>
+static uint32_t compare(const table_t *tab, const uint8_t buf[], const int32_t yieldCor[]) {
+    testRec_t<VAL> gen, ref;
+    gen.assign = ref.assign = tab->assign;
+    gen.length = ref.length = tab->length;
+    // calculated fields are written by neither
+    for(uint8_t pos = 0; pos < MAX_REC_LEN; pos++)
+        gen.record[pos] = ref.record[pos] = VAL();
+
+    if(!assignDecoder::decode(tab->assign, &gen, buf, yieldCor)) {
+        printf("%s: no generated decoder\n", tab->name);
+        return tab->length;
+    }
+    for(uint8_t pos = 0; pos < tab->length; pos++)
+        assignDecoder::interpret(&ref, pos, buf, yieldCor);
+
+    uint32_t errors = 0;
+    for(uint8_t pos = 0; pos < tab->length; pos++) {
+        if(gen.record[pos] != ref.record[pos]) {
+            printf("%s pos %u (field %u, ch %u): %f != %f\n", tab->name, pos,
+                tab->assign[pos].fieldId, tab->assign[pos].ch,
+                ah::toFloat(gen.record[pos]), ah::toFloat(ref.record[pos]));
+            errors++;
+        }
+    }
+    return errors;
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t num = 10000, seed = 1;
+    int opt;
+    while(-1 != (opt = getopt(argc, argv, "n:s:"))) {
+        switch(opt) {
+            case 'n': num  = atoi(optarg); break;
+            case 's': seed = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-n payloads per table] [-s seed]\n", argv[0]);
+                return 1;
+        }
+    }
+    srand(seed);
+
+    uint32_t errors = 0;
+    for(uint8_t t = 0; t < NUM_TABLES; t++) {
+        const table_t *tab = &tables[t];
+        uint8_t len = 0;
+        for(uint8_t pos = 0; pos < tab->length; pos++) {
+            if((tab->assign[pos].start + tab->assign[pos].num) > len)
+                len = tab->assign[pos].start + tab->assign[pos].num;
+        }
+
+        uint32_t tabErrors = 0;
+        for(uint32_t i = 0; i < num; i++) {
+            uint8_t buf[MAX_REC_LEN];
+            int32_t yieldCor[4];
+            for(uint8_t j = 0; j < len; j++)
+                buf[j] = rand();
+            for(uint8_t ch = 0; ch < 4; ch++)
+                yieldCor[ch] = (0 == (i % 2)) ? 0 : (rand() % 2000);
+            tabErrors += compare<float>(tab, buf, yieldCor);
+            tabErrors += compare<ah::Fixed>(tab, buf, yieldCor);
+            if(tabErrors > 10)
+                break;
+        }
+        printf("%-16s %2u fields, %3u byte payload, %u mismatches\n", tab->name, tab->length, len, tabErrors);
+        errors += tabErrors;
+    }
+    return (0 == errors) ? 0 : 1;
+}
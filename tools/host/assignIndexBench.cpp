@@ -0,0 +1,116 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+// checks the (channel, field) index (assignIndex::get) against the linear
+// search of the assignment table for all pairs of all six tables and
+// compares the time of both lookups as done by Inverter::getPosByChFld()
+//
+// usage: assignIndexBench [-n lookups] [-s seed]
+
+#include <Arduino.h>
+#include <chrono>
+#include <unistd.h>
+#include "hm/assignIndex.h"
+
+typedef struct {
+    const char *name;
+    const byteAssign_t *assign;
+    uint8_t length;
+} table_t;
+
+static const table_t tables[] = {
+    {"hm1ch",            hm1chAssignment,            HM1CH_LIST_LEN},
+    {"hm2ch",            hm2chAssignment,            HM2CH_LIST_LEN},
+    {"hm4ch",            hm4chAssignment,            HM4CH_LIST_LEN},
+    {"Info",             InfoAssignment,             HMINFO_LIST_LEN},
+    {"SystemConfigPara", SystemConfigParaAssignment, HMSYSTEM_LIST_LEN},
+    {"AlarmData",        AlarmDataAssignment,        HMALARMDATA_LIST_LEN}
+};
+#define NUM_TABLES  (sizeof(tables) / sizeof(table_t))
+
+static uint8_t search(const table_t *tab, uint8_t channel, uint8_t fieldId) {
+    uint8_t pos = 0;
+    for(; pos < tab->length; pos++) {
+        if((tab->assign[pos].ch == channel) && (tab->assign[pos].fieldId == fieldId))
+            break;
+    }
+    return (pos >= tab->length) ? 0xff : pos;
+}
+
+static uint8_t lookup(const uint8_t *idx, uint8_t channel, uint8_t fieldId) {
+    if((channel >= ASSIGN_IDX_CH) || (fieldId >= ASSIGN_IDX_FLD))
+        return 0xff;
+    return idx[channel * ASSIGN_IDX_FLD + fieldId];
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t num = 1000000, seed = 1;
+    int opt;
+    while(-1 != (opt = getopt(argc, argv, "n:s:"))) {
+        switch(opt) {
+            case 'n': num  = atoi(optarg); break;
+            case 's': seed = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-n lookups] [-s seed]\n", argv[0]);
+                return 1;
+        }
+    }
+    srand(seed);
+
+    uint32_t errors = 0;
+    uint8_t *ch  = new uint8_t[num];
+    uint8_t *fld = new uint8_t[num];
+    for(uint8_t t = 0; t < NUM_TABLES; t++) {
+        const table_t *tab = &tables[t];
+        const uint8_t *idx = assignIndex::get(tab->assign, tab->length);
+        if(NULL == idx) {
+            printf("%s: no index\n", tab->name);
+            errors++;
+            continue;
+        }
+        if(idx != assignIndex::get(tab->assign, tab->length)) {
+            printf("%s: index is not shared\n", tab->name);
+            errors++;
+        }
+
+        // all pairs, including the ones outside of the index
+        uint32_t tabErrors = 0;
+        for(uint16_t c = 0; c <= 0xff; c++) {
+            for(uint16_t f = 0; f <= 0xff; f++) {
+                if(lookup(idx, c, f) != search(tab, c, f))
+                    tabErrors++;
+            }
+        }
+
+        // three of four lookups are fields of the table
+        for(uint32_t i = 0; i < num; i++) {
+            if(0 != (i % 4)) {
+                const byteAssign_t *a = &tab->assign[rand() % tab->length];
+                ch[i]  = a->ch;
+                fld[i] = a->fieldId;
+            } else {
+                ch[i]  = rand() % ASSIGN_IDX_CH;
+                fld[i] = rand() % ASSIGN_IDX_FLD;
+            }
+        }
+
+        volatile uint8_t sink = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for(uint32_t i = 0; i < num; i++)
+            sink ^= search(tab, ch[i], fld[i]);
+        auto t1 = std::chrono::steady_clock::now();
+        for(uint32_t i = 0; i < num; i++)
+            sink ^= lookup(idx, ch[i], fld[i]);
+        auto t2 = std::chrono::steady_clock::now();
+        double nsSearch = std::chrono::duration<double, std::nano>(t1 - t0).count() / num;
+        double nsIndex  = std::chrono::duration<double, std::nano>(t2 - t1).count() / num;
+        printf("%-16s %2u fields, %u mismatches, search %6.2f ns, index %6.2f ns\n",
+            tab->name, tab->length, tabErrors, nsSearch, nsIndex);
+        errors += tabErrors;
+    }
+    delete[] ch;
+    delete[] fld;
+    return (0 == errors) ? 0 : 1;
+}
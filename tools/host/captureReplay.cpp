@@ -0,0 +1,289 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+// replays a capture of the DTU (/get_capture, capture.bin) through HmPayload
+// and MiPayload and reports the decode throughput. The recorded requests
+// start the payloads, the recorded fragments are added like received ones.
+// Without -f the trace is recorded from the simulated RF medium (SimRadio),
+// -w writes its last CAPTURE_MAX_RECORDS records as capture file.
+// The type of an inverter is given with -i, otherwise it is derived from the
+// capture: HM by the fragments of its live data answer, MI 2 channels.
+// Dev control requests are not replayed.
+//
+// usage: captureReplay [-f capture.bin] [-w capture.bin] [-i serial (hex)]
+//                      [-n inverters] [-r requests] [-l rounds] [-s seed]
+
+#include <Arduino.h>
+#include <chrono>
+#include <vector>
+#include <unistd.h>
+#include "appInterface.h"
+#include "hm/hmPayload.h"
+#include "hm/miPayload.h"
+
+uint64_t hostClockUs = 0;
+bool hostSerialOut   = false;
+HardwareSerial Serial;
+EspClass ESP;
+FS LittleFS;
+SPIClass SPI;
+
+typedef HmSystem<MAX_NUM_INVERTERS> HmSystemType;
+typedef HmPayload<HmSystemType> PayloadType;
+typedef MiPayload<HmSystemType> MiPayloadType;
+
+#define SIM_LOOP_US     1000 // virtual time of one pass of the main loop
+#define MAX_SERIALS     16   // -i options
+
+static HmSystemType sys;
+static PayloadType hmPayload;
+static MiPayloadType miPayload;
+static statistics_t stat;
+static cfgInst_t inst;
+static uint8_t ivCnt = 0;
+static uint32_t timestamp = 1700000000;
+static std::vector<capRecord_t> trace;
+
+//-----------------------------------------------------------------------------
+static bool readCapture(const char *path) {
+    FILE *fp = fopen(path, "rb");
+    if(NULL == fp) {
+        fprintf(stderr, "can't open %s\n", path);
+        return false;
+    }
+    capHeader_t hdr;
+    if((1 != fread(&hdr, sizeof(hdr), 1, fp)) || (CAPTURE_MAGIC != hdr.magic) || (hdr.next >= CAPTURE_MAX_RECORDS) || (hdr.cnt > CAPTURE_MAX_RECORDS)) {
+        fprintf(stderr, "%s is no capture\n", path);
+        fclose(fp);
+        return false;
+    }
+    // from the oldest to the newest record
+    for(uint16_t n = 0; n < hdr.cnt; n++) {
+        capRecord_t r;
+        uint16_t idx = (hdr.next + CAPTURE_MAX_RECORDS - hdr.cnt + n) % CAPTURE_MAX_RECORDS;
+        fseek(fp, sizeof(capHeader_t) + idx * sizeof(capRecord_t), SEEK_SET);
+        if(1 != fread(&r, sizeof(r), 1, fp))
+            break;
+        if(r.len > MAX_RF_PAYLOAD_SIZE)
+            continue;
+        trace.push_back(r);
+    }
+    fclose(fp);
+    return true;
+}
+
+// same layout as RadioCapture writes it
+static bool writeCapture(const char *path) {
+    FILE *fp = fopen(path, "wb");
+    if(NULL == fp) {
+        fprintf(stderr, "can't create %s\n", path);
+        return false;
+    }
+    size_t first = (trace.size() > CAPTURE_MAX_RECORDS) ? (trace.size() - CAPTURE_MAX_RECORDS) : 0;
+    capHeader_t hdr;
+    hdr.magic = CAPTURE_MAGIC;
+    hdr.cnt   = trace.size() - first;
+    hdr.next  = hdr.cnt % CAPTURE_MAX_RECORDS;
+    bool ok = (1 == fwrite(&hdr, sizeof(hdr), 1, fp));
+    for(size_t n = first; ok && (n < trace.size()); n++)
+        ok = (1 == fwrite(&trace[n], sizeof(capRecord_t), 1, fp));
+    fclose(fp);
+    if(!ok)
+        fprintf(stderr, "can't write %s\n", path);
+    return ok;
+}
+
+static Inverter<> *addInverter(uint64_t serial) {
+    if(ivCnt >= MAX_NUM_INVERTERS)
+        return NULL;
+    uint8_t i = ivCnt++;
+    cfgIv_t *cfg = &inst.iv[i];
+    cfg->enabled    = true;
+    cfg->serial.u64 = serial;
+    snprintf(cfg->name, MAX_NAME_LENGTH, "iv%u", i);
+    for(uint8_t ch = 0; ch < 4; ch++)
+        cfg->chMaxPwr[ch] = 400;
+    Inverter<> *iv = sys.addInverter(cfg);
+    if(NULL != iv)
+        iv->initialized = true;
+    return iv;
+}
+
+// inverters of the capture which were not given with -i
+static void addCapturedInverters(void) {
+    static const uint8_t types[] = {0x21, 0x21, 0x21, 0x41, 0x61}; // by the number of fragments
+    for(size_t n = 0; n < trace.size(); n++) {
+        capRecord_t *r = &trace[n];
+        if(!(r->flags & CAPTURE_TX) || (r->len < 11) || (NULL != sys.findInverter(&r->data[1])))
+            continue;
+        uint32_t addr = ((uint32_t)r->data[1] << 24) | ((uint32_t)r->data[2] << 16) | ((uint32_t)r->data[3] << 8) | r->data[4];
+        uint64_t serial = 0x10410000ULL << 16; // MI 2 channels
+        if(TX_REQ_INFO == r->data[0]) {
+            uint8_t frags = 0;
+            for(size_t m = n + 1; m < trace.size(); m++) {
+                const capRecord_t *a = &trace[m];
+                if(a->flags & CAPTURE_TX) {
+                    if(0 != memcmp(&a->data[1], &r->data[1], 4))
+                        break; // request of another inverter
+                    continue;
+                }
+                if((RealTimeRunData_Debug == r->data[10]) && ((TX_REQ_INFO + ALL_FRAMES) == a->data[0]) && (a->data[9] > ALL_FRAMES))
+                    frags = a->data[9] & 0x7f;
+            }
+            if(0 == frags)
+                continue; // type not known yet, maybe of a later live data request
+            serial = (0x1100ULL | types[(frags > 4) ? 4 : frags]) << 32;
+        }
+        if(NULL == addInverter(serial | addr)) {
+            fprintf(stderr, "too many inverters\n");
+            exit(1);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+static void record(uint8_t flags, uint8_t ch, const uint8_t buf[], uint8_t len) {
+    capRecord_t r;
+    memset(&r, 0, sizeof(r));
+    r.ts    = micros();
+    r.flags = flags;
+    r.ch    = ch;
+    r.len   = len;
+    memcpy(r.data, buf, len);
+    trace.push_back(r);
+}
+
+// records the live data requests of the simulated inverters and their answers
+static void generate(uint8_t inverters, uint32_t requests) {
+    static const uint8_t types[] = {0x21, 0x41, 0x61}; // 1, 2 and 4 channels
+    for(uint8_t i = 0; i < inverters; i++)
+        addInverter(0x110000000000ULL | ((uint64_t)types[i % 3] << 32) | (0x10000000 + i));
+
+    for(uint32_t n = 0; n < requests; n++) {
+        Inverter<> *iv = sys.getInverterByPos(n % inverters);
+        uint8_t req[27];
+        memset(req, 0, sizeof(req));
+        req[0] = TX_REQ_INFO;
+        for(uint8_t i = 0; i < 4; i++)
+            req[1 + i] = iv->config->serial.b[3 - i];
+        req[9]  = ALL_FRAMES;
+        req[10] = RealTimeRunData_Debug;
+        record(CAPTURE_TX, 0, req, sizeof(req));
+
+        sys.Radio.prepareDevInformCmd(iv, RealTimeRunData_Debug, timestamp, 0, false);
+        while(!sys.loop())
+            hostAdvanceUs(SIM_LOOP_US);
+        packet_t *p;
+        while(NULL != (p = sys.getPacket())) {
+            record(0, p->ch, p->packet, p->len);
+            sys.popPacket();
+        }
+        timestamp += 5;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// like the packet drain of the firmware, returns the added fragments
+static uint32_t replay(void) {
+    uint32_t frames = 0;
+    packet_t pkt;
+    for(size_t n = 0; n < trace.size(); n++) {
+        capRecord_t *r = &trace[n];
+        Inverter<> *iv = sys.findInverter(&r->data[1]);
+        if((NULL == iv) || (TX_REQ_DEVCONTROL == r->data[0]) || ((TX_REQ_DEVCONTROL + ALL_FRAMES) == r->data[0]))
+            continue;
+
+        if(r->flags & CAPTURE_TX) {
+            if(0 == (r->flags & CAPTURE_RETRANSMIT)) { // new request, finish the last one
+                hmPayload.process(false);
+                miPayload.process(false);
+                if(IV_HM == iv->ivGen)
+                    hmPayload.replayRequest(iv, r->data[10]);
+                else
+                    miPayload.replayRequest(iv, r->data[0]);
+            }
+        } else if(0 == (r->flags & CAPTURE_CRC_FAIL)) {
+            pkt.ch  = r->ch;
+            pkt.len = r->len;
+            pkt.ts  = r->ts;
+            memcpy(pkt.packet, r->data, r->len);
+            if(!iv->isRxDuplicate(pkt.packet, pkt.len)) {
+                if(IV_HM == iv->ivGen)
+                    hmPayload.add(iv, &pkt);
+                else
+                    miPayload.add(iv, &pkt);
+                frames++;
+            }
+        }
+    }
+    hmPayload.process(false);
+    miPayload.process(false);
+    return frames;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = NULL, *outPath = NULL;
+    uint64_t serials[MAX_SERIALS];
+    uint8_t serialCnt = 0, inverters = 12;
+    uint32_t requests = 2000, rounds = 20, seed = 1;
+    int opt;
+    while(-1 != (opt = getopt(argc, argv, "f:w:i:n:r:l:s:"))) {
+        switch(opt) {
+            case 'f': path      = optarg; break;
+            case 'w': outPath   = optarg; break;
+            case 'i':
+                if(serialCnt < MAX_SERIALS)
+                    serials[serialCnt++] = strtoull(optarg, NULL, 16);
+                break;
+            case 'n': inverters = atoi(optarg); break;
+            case 'r': requests  = atoi(optarg); break;
+            case 'l': rounds    = atoi(optarg); break;
+            case 's': seed      = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-f capture.bin] [-w capture.bin] [-i serial (hex)] [-n inverters] [-r requests] [-l rounds] [-s seed]\n", argv[0]);
+                return 1;
+        }
+    }
+    if((0 == inverters) || (inverters > MAX_NUM_INVERTERS) || (0 == rounds)) {
+        fprintf(stderr, "1 to %d inverters, at least one round\n", MAX_NUM_INVERTERS);
+        return 1;
+    }
+    randomSeed(seed);
+
+    memset(&stat, 0, sizeof(stat));
+    memset(&inst, 0, sizeof(inst));
+    sys.setup(0, 0, 0, 0, 0, 0, 0);
+    for(uint8_t i = 0; i < serialCnt; i++)
+        addInverter(serials[i]);
+    if(NULL != path) {
+        if(!readCapture(path))
+            return 1;
+        addCapturedInverters();
+    } else {
+        generate(inverters, requests);
+        if((NULL != outPath) && !writeCapture(outPath))
+            return 1;
+    }
+
+    // without app, dev control answers are skipped by replay()
+    hmPayload.setup(NULL, &sys, &stat, 0, &timestamp);
+    miPayload.setup(NULL, &sys, &stat, 0, &timestamp);
+
+    uint32_t frames = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(uint32_t l = 0; l < rounds; l++)
+        frames += replay();
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+
+    printf("%u records of %u inverters %s, %u rounds\n", (uint32_t)trace.size(), ivCnt, (NULL != path) ? path : "(generated)", rounds);
+    printf("fragments: %u, payloads: %u complete\n", frames, stat.rxSuccess);
+    printf("decode:    %.2f us/fragment, %.0f fragments/s\n", (0 == frames) ? 0 : (wall.count() * 1e6 / frames), wall.count() > 0 ? (frames / wall.count()) : 0);
+
+    if(0 == stat.rxSuccess) {
+        printf("FAIL: no payload was complete\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,9 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+// host programs: the simulation handles more inverters than fit into the
+// ESPs RAM, inverter ids are uint8_t
+#undef MAX_NUM_INVERTERS
+#define MAX_NUM_INVERTERS   200
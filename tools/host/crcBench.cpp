@@ -0,0 +1,121 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+// checks that the three CRC implementations (CRC_IMPL) return the same
+// crc8 and crc16 for random buffers and compares their run time
+//
+// usage: crcBench [-n buffers] [-s seed]
+
+#include <Arduino.h>
+#include <chrono>
+#include <unistd.h>
+
+// each implementation gets its own namespace
+#define ah crcBitwise
+#define CRC_IMPL CRC_IMPL_BITWISE
+#include "utils/crc.cpp"
+#undef ah
+#undef CRC_IMPL
+#undef __CRC_H__
+
+#define ah crcTable
+#define CRC_IMPL CRC_IMPL_TABLE
+#include "utils/crc.cpp"
+#undef ah
+#undef CRC_IMPL
+#undef __CRC_H__
+
+#define ah crcSlice4
+#define CRC_IMPL CRC_IMPL_SLICE4
+#include "utils/crc.cpp"
+#undef ah
+
+#define MAX_BUF_LEN     255
+#define BENCH_LOOPS     20
+
+typedef struct {
+    const char *name;
+    uint8_t (*crc8)(uint8_t buf[], uint8_t len);
+    uint16_t (*crc16)(uint8_t buf[], uint8_t len, uint16_t start);
+} crcImpl_t;
+
+static const crcImpl_t impls[] = {
+    {"BITWISE", crcBitwise::crc8, crcBitwise::crc16},
+    {"TABLE",   crcTable::crc8,   crcTable::crc16},
+    {"SLICE4",  crcSlice4::crc8,  crcSlice4::crc16}
+};
+#define NUM_IMPLS   (sizeof(impls) / sizeof(crcImpl_t))
+
+int main(int argc, char *argv[]) {
+    uint32_t num = 10000, seed = 1;
+    int opt;
+    while(-1 != (opt = getopt(argc, argv, "n:s:"))) {
+        switch(opt) {
+            case 'n': num  = atoi(optarg); break;
+            case 's': seed = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-n buffers] [-s seed]\n", argv[0]);
+                return 1;
+        }
+    }
+    srand(seed);
+
+    // random lengths including 0 and the unaligned tails of SLICE4
+    uint8_t *buf = new uint8_t[num * MAX_BUF_LEN];
+    uint8_t *len = new uint8_t[num];
+    uint16_t *start = new uint16_t[num];
+    for(uint32_t i = 0; i < num * MAX_BUF_LEN; i++)
+        buf[i] = rand();
+    for(uint32_t i = 0; i < num; i++) {
+        len[i]   = (i < (MAX_BUF_LEN + 1)) ? i : (rand() % (MAX_BUF_LEN + 1));
+        start[i] = (0 == (i % 2)) ? 0xffff : rand();
+    }
+
+    uint32_t errors = 0;
+    for(uint32_t i = 0; i < num; i++) {
+        uint8_t *b = &buf[i * MAX_BUF_LEN];
+        uint8_t ref8 = impls[0].crc8(b, len[i]);
+        uint16_t ref16 = impls[0].crc16(b, len[i], start[i]);
+        for(uint8_t j = 1; j < NUM_IMPLS; j++) {
+            uint8_t c8 = impls[j].crc8(b, len[i]);
+            uint16_t c16 = impls[j].crc16(b, len[i], start[i]);
+            if((c8 != ref8) || (c16 != ref16)) {
+                if(errors < 10)
+                    printf("%s differs, len %u, start 0x%04x: crc8 0x%02x/0x%02x, crc16 0x%04x/0x%04x\n",
+                        impls[j].name, len[i], start[i], c8, ref8, c16, ref16);
+                errors++;
+            }
+        }
+    }
+    printf("%u buffers, %u mismatches\n", num, errors);
+
+    uint64_t bytes = 0;
+    for(uint32_t i = 0; i < num; i++)
+        bytes += len[i];
+    bytes *= BENCH_LOOPS;
+
+    for(uint8_t j = 0; j < NUM_IMPLS; j++) {
+        volatile uint16_t sink = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for(uint8_t l = 0; l < BENCH_LOOPS; l++) {
+            for(uint32_t i = 0; i < num; i++)
+                sink ^= impls[j].crc16(&buf[i * MAX_BUF_LEN], len[i], 0xffff);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        for(uint8_t l = 0; l < BENCH_LOOPS; l++) {
+            for(uint32_t i = 0; i < num; i++)
+                sink ^= impls[j].crc8(&buf[i * MAX_BUF_LEN], len[i]);
+        }
+        auto t2 = std::chrono::steady_clock::now();
+        double ns16 = std::chrono::duration<double, std::nano>(t1 - t0).count();
+        double ns8  = std::chrono::duration<double, std::nano>(t2 - t1).count();
+        printf("%-8s crc16 %6.2f ns/byte, crc8 %6.2f ns/byte\n", impls[j].name, ns16 / bytes, ns8 / bytes);
+    }
+
+    delete[] buf;
+    delete[] len;
+    delete[] start;
+    return (0 == errors) ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+// decodes and formats random hm4ch payloads with float and with ah::Fixed
+// records (ENABLE_FIXED_POINT): checks that both agree to 1/1000 and that the
+// fixed point text reads back as its value, then times decode + format.
+// The host has a FPU, the ESP8266 calculates float in software.
+//
+// usage: fixedBench [-n payloads] [-s seed]
+
+#include <Arduino.h>
+#include <chrono>
+#include <unistd.h>
+#include "hm/assignDecoder.h"
+
+#define REC_LEN     HM4CH_LIST_LEN
+#define PYLD_LEN    62
+#define VAL_LEN     16
+
+// the part of record_t the decoders use
+template <class VAL>
+struct testRec_t {
+    typedef VAL value_type;
+
+    VAL record[REC_LEN];
+
+    void set(uint8_t pos, const VAL &val) {
+        record[pos] = val;
+    }
+};
+
+// decode and format all values of each payload, returns the sum of the text lengths
+template <class VAL>
+static uint32_t run(const uint8_t *pyld, uint32_t num, const int32_t yieldCor[], double *ns) {
+    testRec_t<VAL> rec;
+    char buf[VAL_LEN];
+    uint32_t chars = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < num; i++) {
+        assignDecoder::decode(hm4chAssignment, &rec, &pyld[i * PYLD_LEN], yieldCor);
+        for(uint8_t pos = 0; pos < REC_LEN; pos++) {
+            if(CMD_CALC == hm4chAssignment[pos].div)
+                continue;
+            ah::fmtValue(buf, VAL_LEN, rec.record[pos]);
+            chars += strlen(buf);
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    *ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / num;
+    return chars;
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t num = 100000, seed = 1;
+    int opt;
+    while(-1 != (opt = getopt(argc, argv, "n:s:"))) {
+        switch(opt) {
+            case 'n': num  = atoi(optarg); break;
+            case 's': seed = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-n payloads] [-s seed]\n", argv[0]);
+                return 1;
+        }
+    }
+    srand(seed);
+
+    uint8_t *pyld = new uint8_t[num * PYLD_LEN];
+    for(uint32_t i = 0; i < num * PYLD_LEN; i++)
+        pyld[i] = rand();
+    // a total yield of more than 2147 MWh (incl. the yield correction)
+    // exceeds the range of ah::Fixed, it is not a real value of a micro
+    // inverter
+    for(uint32_t i = 0; i < num; i++) {
+        for(uint8_t pos = 0; pos < REC_LEN; pos++) {
+            if((FLD_YT == hm4chAssignment[pos].fieldId) && (CMD_CALC != hm4chAssignment[pos].div))
+                pyld[i * PYLD_LEN + hm4chAssignment[pos].start] &= 0x3f;
+        }
+    }
+    const int32_t yieldCor[4] = {0, 12, 345, 6789};
+
+    uint32_t errors = 0;
+    for(uint32_t i = 0; i < num; i++) {
+        testRec_t<float> flt;
+        testRec_t<ah::Fixed> fix;
+        assignDecoder::decode(hm4chAssignment, &flt, &pyld[i * PYLD_LEN], yieldCor);
+        assignDecoder::decode(hm4chAssignment, &fix, &pyld[i * PYLD_LEN], yieldCor);
+        for(uint8_t pos = 0; pos < REC_LEN; pos++) {
+            if(CMD_CALC == hm4chAssignment[pos].div)
+                continue;
+            char buf[VAL_LEN];
+            ah::fmtValue(buf, VAL_LEN, fix.record[pos]);
+            // float has a 24 bit mantissa, allow the rounding error of the
+            // division and the yield correction
+            double diff = fabs((double)fix.record[pos].raw() - (double)flt.record[pos] * FIXED_SCALE);
+            bool ok = (diff <= (1.0 + fabs(flt.record[pos]) * FIXED_SCALE * 2.5e-7));
+            ok &= (lround(strtod(buf, NULL) * FIXED_SCALE) == fix.record[pos].raw());
+            if(!ok) {
+                if(errors < 10)
+                    printf("pos %u (field %u, ch %u): float %f, fixed %s\n", pos,
+                        hm4chAssignment[pos].fieldId, hm4chAssignment[pos].ch, flt.record[pos], buf);
+                errors++;
+            }
+        }
+    }
+    printf("%u payloads, %u mismatches\n", num, errors);
+
+    double nsFloat, nsFixed;
+    uint32_t charsFloat = run<float>(pyld, num, yieldCor, &nsFloat);
+    uint32_t charsFixed = run<ah::Fixed>(pyld, num, yieldCor, &nsFixed);
+    printf("float  %7.1f ns per payload (decode + format), %u chars\n", nsFloat, charsFloat);
+    printf("fixed  %7.1f ns per payload (decode + format), %u chars\n", nsFixed, charsFixed);
+
+    delete[] pyld;
+    return (0 == errors) ? 0 : 1;
+}
@@ -0,0 +1,230 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+// load test of the HM protocol stack on the host: payload assembly,
+// retransmits and the polling cadence of the scheduler of the firmware
+// (hm/ivScheduler.h) run against the simulated RF medium (SimRadio) with many
+// virtual inverters and a virtual clock. MI (2nd gen) inverters are not
+// answered by the simulation.
+//
+// Fails (exit code 1) if less payloads than the minimum complete ratio were
+// assembled (default: 100% - loss%), if the rx buffer overflowed or if an
+// inverter was never refreshed.
+//
+// usage: ivSim [-n inverters] [-t seconds] [-l loss%] [-d dup%] [-L latency ms]
+//              [-i send interval s] [-r max retransmits] [-s seed]
+//              [-c min complete%] [-v]
+
+#include <Arduino.h>
+#include <chrono>
+#include <unistd.h>
+#include "appInterface.h"
+#include "hm/hmPayload.h"
+#include "hm/miPayload.h"
+#include "hm/ivScheduler.h"
+
+uint64_t hostClockUs = 0;
+bool hostSerialOut   = false;
+HardwareSerial Serial;
+EspClass ESP;
+FS LittleFS;
+SPIClass SPI;
+
+typedef HmSystem<MAX_NUM_INVERTERS> HmSystemType;
+typedef HmPayload<HmSystemType> PayloadType;
+typedef MiPayload<HmSystemType> MiPayloadType;
+typedef IvScheduler<HmSystemType, PayloadType, MiPayloadType> IvSchedulerType;
+
+#define SIM_LOOP_US     1000 // virtual time of one pass of the main loop
+
+//-----------------------------------------------------------------------------
+class SimApp : public IApp {
+    public:
+        SimApp() : mTimestamp(1700000000), mSendInterval(5) {
+            memset(&mStat, 0, sizeof(mStat));
+            memset(&mInst, 0, sizeof(mInst));
+        }
+
+        void setup(uint16_t inverters, uint8_t loss, uint8_t dup, uint16_t latency, uint8_t maxRetrans, uint16_t interval, bool debug) {
+            mSendInterval = interval;
+            mSys.setup(0, 0, 0, 0, 0, 0, 0);
+            for(uint8_t i = 0; i < RF_CHANNELS; i++)
+                mSys.Radio.setMedium(i, loss, dup, latency);
+            if(debug)
+                mSys.enableDebug();
+
+            const uint8_t types[] = {0x21, 0x41, 0x61}; // 1, 2 and 4 channels
+            for(uint16_t i = 0; i < inverters; i++) {
+                cfgIv_t *cfg = &mInst.iv[i];
+                cfg->enabled    = true;
+                cfg->serial.u64 = 0x110000000000ULL | ((uint64_t)types[i % 3] << 32) | (0x10000000 + i);
+                snprintf(cfg->name, MAX_NAME_LENGTH, "sim%u", i);
+                for(uint8_t ch = 0; ch < 4; ch++)
+                    cfg->chMaxPwr[ch] = 400;
+                Inverter<> *iv = mSys.addInverter(cfg);
+                if(NULL != iv)
+                    iv->initialized = true;
+            }
+            mPayload.setup(this, &mSys, &mStat, maxRetrans, &mTimestamp);
+            mPayload.enableSerialDebug(debug);
+            mMiPayload.setup(this, &mSys, &mStat, maxRetrans, &mTimestamp);
+            mMiPayload.enableSerialDebug(debug);
+            mIvSched.setup(&mSys, &mPayload, &mMiPayload, &mStat, &mSendInterval);
+            mIvSched.enableSerialDebug(debug);
+        }
+
+        // like app::loopStandard()
+        void loop(void) {
+            mIvSched.loop(true);
+        }
+
+        // like app::tickSend()
+        void tickSecond(void) {
+            mTimestamp++;
+            mIvSched.sendNext();
+        }
+
+        // returns false if a threshold is missed
+        bool report(uint32_t seconds, double wallSec, uint8_t minCompletePct) {
+            uint32_t complete = 0, ageSum = 0, ageCnt = 0, ageMax = 0, neverCnt = 0;
+            for(uint16_t i = 0; i < mSys.getNumInverters(); i++) {
+                Inverter<> *iv = mSys.getInverterByPos(i);
+                if(NULL == iv)
+                    continue;
+                for(uint8_t b = 0; b < REFRESH_BUCKETS; b++)
+                    complete += iv->refresh.age.bucket[b];
+                if(0 == iv->refresh.lastMs) {
+                    neverCnt++;
+                    continue;
+                }
+                uint32_t age = iv->getRefreshAge();
+                ageSum += age;
+                ageCnt++;
+                if(age > ageMax)
+                    ageMax = age;
+            }
+            printf("simulated %us, %.2fs wall clock\n", seconds, wallSec);
+            printf("requests:  %u, retransmits: %u\n", mSys.Radio.mSendCnt, mSys.Radio.mRetransmits);
+            printf("payloads:  %u ok, %u incomplete, %u no answer\n", mStat.rxSuccess, mStat.rxFail, mStat.rxFailNoAnser);
+            printf("fragments: %u, duplicates: %u, rx buffer overflow: %u, high water: %u\n",
+                mStat.frmCnt, mStat.frmDup, mStat.rxBufOverflow, mStat.rxBufHighWater);
+            printf("refreshes: %u, age now: avg %us, max %us, never refreshed: %u\n",
+                complete, (0 == ageCnt) ? 0 : (ageSum / ageCnt), ageMax, neverCnt);
+
+            bool pass = true;
+            uint32_t requested = mStat.rxSuccess + mStat.rxFail + mStat.rxFailNoAnser;
+            float completePct = (0 == requested) ? 0 : (100.0 * mStat.rxSuccess / requested);
+            if(completePct < minCompletePct) {
+                printf("FAIL: %.1f%% complete payloads, minimum %u%%\n", completePct, minCompletePct);
+                pass = false;
+            }
+            if(0 != mStat.rxBufOverflow) {
+                printf("FAIL: rx buffer overflow\n");
+                pass = false;
+            }
+            if(0 != neverCnt) {
+                printf("FAIL: %u inverters never refreshed\n", neverCnt);
+                pass = false;
+            }
+            return pass;
+        }
+
+        // IApp
+        bool saveSettings(bool stopFs) { return true; }
+        bool readSettings(const char *path) { return true; }
+        bool eraseSettings(bool eraseWifi) { return true; }
+        bool getSavePending() { return false; }
+        bool getLastSaveSucceed() { return true; }
+        bool getShouldReboot() { return false; }
+        void setOnUpdate() {}
+        void setRebootFlag() {}
+        const char *getVersion() { return "sim"; }
+        statistics_t *getStatistics() { return &mStat; }
+        void scanAvailNetworks() {}
+        void getAvailNetworks(JsonObject obj) {}
+        uint32_t getUptime() { return millis() / 1000; }
+        uint32_t getTimestamp() { return mTimestamp; }
+        uint32_t getSunrise() { return 0; }
+        uint32_t getSunset() { return 0; }
+        void setTimestamp(uint32_t newTime) { mTimestamp = newTime; }
+        String getTimeStr(uint32_t offset) { return String(mTimestamp + offset); }
+        uint32_t getTimezoneOffset() { return 0; }
+        void getSchedulerInfo(uint8_t *max) {}
+        void getSchedulerNames() {}
+        bool getRebootRequestState() { return false; }
+        bool getSettingsValid() { return true; }
+        void setMqttDiscoveryFlag() {}
+        void setMqttPowerLimitAck(Inverter<> *iv) {}
+        void ivSendHighPrio(Inverter<> *iv) { mPayload.ivSendHighPrio(iv); }
+        void setCaptureEnable(bool enable) {}
+        void clearCapture() {}
+        bool getMqttIsConnected() { return false; }
+        uint32_t getMqttRxCnt() { return 0; }
+        uint32_t getMqttTxCnt() { return 0; }
+        bool getProtection(AsyncWebServerRequest *request) { return false; }
+
+    private:
+        HmSystemType mSys;
+        PayloadType mPayload;
+        MiPayloadType mMiPayload;
+        IvSchedulerType mIvSched;
+        statistics_t mStat;
+        cfgInst_t mInst;
+        uint32_t mTimestamp;
+        uint16_t mSendInterval;
+};
+
+static SimApp app; // too large for the stack with many inverters
+
+int main(int argc, char *argv[]) {
+    uint16_t inverters = MAX_NUM_INVERTERS, latency = SIM_RADIO_LATENCY_MS, interval = 5;
+    uint32_t seconds = 600, seed = 1;
+    uint8_t loss = SIM_RADIO_LOSS_PCT, dup = SIM_RADIO_DUP_PCT, maxRetrans = 5;
+    int16_t minComplete = -1; // derived from the loss
+    bool debug = false;
+
+    int opt;
+    while(-1 != (opt = getopt(argc, argv, "n:t:l:d:L:i:r:s:c:v"))) {
+        switch(opt) {
+            case 'n': inverters  = atoi(optarg); break;
+            case 't': seconds    = atoi(optarg); break;
+            case 'l': loss       = atoi(optarg); break;
+            case 'd': dup        = atoi(optarg); break;
+            case 'L': latency    = atoi(optarg); break;
+            case 'i': interval   = atoi(optarg); break;
+            case 'r': maxRetrans = atoi(optarg); break;
+            case 's': seed       = atoi(optarg); break;
+            case 'c': minComplete = atoi(optarg); break;
+            case 'v': debug      = true; break;
+            default:
+                fprintf(stderr, "usage: %s [-n inverters] [-t seconds] [-l loss%%] [-d dup%%] [-L latency ms] [-i interval s] [-r retransmits] [-s seed] [-c min complete%%] [-v]\n", argv[0]);
+                return 1;
+        }
+    }
+    if(inverters > MAX_NUM_INVERTERS) {
+        fprintf(stderr, "at most %d inverters (MAX_NUM_INVERTERS)\n", MAX_NUM_INVERTERS);
+        return 1;
+    }
+
+    if(minComplete < 0)
+        minComplete = (loss < 100) ? (100 - loss) : 0;
+
+    randomSeed(seed);
+    hostSerialOut = debug;
+    app.setup(inverters, loss, dup, latency, maxRetrans, interval, debug);
+
+    auto start = std::chrono::steady_clock::now();
+    uint32_t nextSec = 0;
+    while(millis() < (seconds * 1000)) {
+        if(millis() >= nextSec) {
+            nextSec += 1000;
+            app.tickSecond();
+        }
+        app.loop();
+        hostAdvanceUs(SIM_LOOP_US);
+    }
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+    return app.report(seconds, wall.count(), minComplete) ? 0 : 1;
+}
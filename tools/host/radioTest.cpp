@@ -0,0 +1,246 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+// checks the receive state machine of HmRadio on the virtual clock against
+// an emulated NRF24 (stub/RF24.h): loop() never blocks, the RX channel hops
+// every RF_CH_DWELL_US, the window ends with the last fragment or after
+// RF_LISTEN_WINDOW_MS, loop() reports each window once and sends the
+// requests of a retransmit burst after the answer to the previous one.
+//
+// usage: radioTest [-v]
+
+#include <Arduino.h>
+#include <unistd.h>
+#include "hm/hmSystem.h"
+
+uint64_t hostClockUs = 0;
+bool hostSerialOut   = false;
+HardwareSerial Serial;
+EspClass ESP;
+FS LittleFS;
+SPIClass SPI;
+
+#define STEP_US         50      // virtual time of one pass of the main loop
+#define FRAG_US         2000    // time between the fragments of an answer
+#define LOOP_MAX_US     500     // max. time of one call of loop()
+
+typedef HmSystem<MAX_NUM_INVERTERS> HmSystemType;
+
+static HmSystemType sys;
+static RF24 *rf;
+static uint32_t errors = 0;
+
+static const uint8_t rfCh[RF_CHANNELS] = {3, 23, 40, 61, 75};
+
+// answer of the emulated inverter to a TX_REQ_INFO
+static struct {
+    uint8_t offset;  // RX channel index relative to the TX channel
+    uint32_t delay;  // [us] request to first fragment
+    uint8_t frags;   // 0: no answer
+    uint8_t sent;    // the fragments after this one get lost
+} answer;
+static uint64_t txUs;
+static uint8_t txCh;
+static uint8_t txCnt;
+
+#define CHECK(cond, ...) do { \
+    if(!(cond)) { \
+        printf("  FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+        errors++; \
+    } \
+} while(0)
+
+static uint8_t getChIdx(uint8_t ch) {
+    for(uint8_t i = 0; i < RF_CHANNELS; i++) {
+        if(rfCh[i] == ch)
+            return i;
+    }
+    return 0;
+}
+
+// fragment number i of the answer to the request in buf
+static void putFragment(const uint8_t buf[], uint8_t rxCh, uint8_t i, uint64_t us) {
+    uint8_t frm[27];
+    memset(frm, 0, sizeof(frm));
+    frm[0] = TX_REQ_INFO + ALL_FRAMES;
+    memcpy(&frm[1], &buf[1], 8); // inverter and DTU id
+    frm[9] = (i == answer.frags) ? (ALL_FRAMES | i) : i;
+    frm[26] = ah::crc8(frm, 26);
+    rf->hostPutOnAir(us, rxCh, frm, sizeof(frm));
+}
+
+static void onTx(uint8_t ch, const uint8_t buf[], uint8_t len) {
+    txUs = hostClockUs;
+    txCh = ch;
+    txCnt++;
+    if(TX_REQ_INFO != buf[0])
+        return;
+    uint8_t rxCh = rfCh[(getChIdx(ch) + answer.offset) % RF_CHANNELS];
+    if(ALL_FRAMES != buf[9]) { // retransmit of a single fragment
+        if(0 != answer.sent)
+            putFragment(buf, rxCh, buf[9] - ALL_FRAMES, txUs + answer.delay);
+        return;
+    }
+    for(uint8_t i = 1; i <= answer.sent; i++)
+        putFragment(buf, rxCh, i, txUs + answer.delay + (i - 1) * FRAG_US);
+}
+
+// sends a request (a retransmit burst of cnt requests if cnt > 0) and runs
+// the main loop until the window is finished, returns the time from the
+// last request to the end of the window
+static uint32_t runWindow(Inverter<> *iv, uint8_t *windows, uint8_t *packets, uint32_t *loopMaxUs, uint8_t pid[] = NULL, uint8_t cnt = 0) {
+    *windows   = 0;
+    *packets   = 0;
+    *loopMaxUs = 0;
+    txCnt      = 0;
+    rf->hostHops.clear();
+    if(0 == cnt)
+        sys.Radio.prepareDevInformCmd(iv, RealTimeRunData_Debug, 1700000000, 0, false);
+    else
+        sys.Radio.sendCmdBurst(iv, TX_REQ_INFO, pid, cnt);
+
+    uint32_t doneUs = 0;
+    uint64_t end = txUs + 2 * RF_LISTEN_WINDOW_MS * 1000UL;
+    while(hostClockUs < end) {
+        uint64_t start = hostClockUs;
+        if(sys.loop()) {
+            (*windows)++;
+            if(0 == doneUs)
+                doneUs = hostClockUs - txUs;
+        }
+        if((hostClockUs - start) > *loopMaxUs)
+            *loopMaxUs = hostClockUs - start;
+        rf->hostPoll();
+        hostAdvanceUs(STEP_US);
+    }
+    while(NULL != sys.getPacket()) {
+        (*packets)++;
+        sys.popPacket();
+    }
+    return doneUs;
+}
+
+static Inverter<> *addInverter(cfgIv_t *cfg, uint64_t serial) {
+    memset(cfg, 0, sizeof(cfgIv_t));
+    cfg->enabled    = true;
+    cfg->serial.u64 = serial;
+    return sys.addInverter(cfg);
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+    while(-1 != (opt = getopt(argc, argv, "v"))) {
+        switch(opt) {
+            case 'v': hostSerialOut = true; break;
+            default:
+                fprintf(stderr, "usage: %s [-v]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    sys.setup(RF24_PA_LOW, DEF_IRQ_PIN, DEF_CE_PIN, DEF_CS_PIN, DEF_SCLK_PIN, DEF_MOSI_PIN, DEF_MISO_PIN);
+    if(hostSerialOut)
+        sys.Radio.enableDebug();
+    rf = hostRf24();
+    rf->hostIrq  = []() { sys.Radio.handleIntr(); };
+    rf->hostOnTx = onTx;
+
+    // every case uses a new inverter, nothing is learned before
+    cfgIv_t cfg[5];
+    uint8_t windows, packets, frags = (HM2CH_PAYLOAD_LEN + 2 + 15) / 16;
+    uint32_t doneUs, loopMaxUs;
+
+    printf("idle\n");
+    for(uint16_t i = 0; i < 1000; i++) {
+        CHECK(!sys.loop(), "loop() reports a window without request");
+        rf->hostPoll();
+        hostAdvanceUs(STEP_US);
+    }
+    CHECK(!sys.Radio.isBusy(), "busy without request");
+
+    printf("answer on the predicted channel\n");
+    answer.offset = RF_RX_OFFSET_DEFAULT;
+    answer.delay  = 1500; // all fragments within the first dwell
+    answer.frags  = frags;
+    answer.sent   = frags;
+    doneUs = runWindow(addInverter(&cfg[0], 0x114172607950ULL), &windows, &packets, &loopMaxUs);
+    uint32_t lastUs = answer.delay + (frags - 1) * FRAG_US;
+    CHECK(1 == windows, "%u windows reported", windows);
+    CHECK(frags == packets, "%u of %u fragments received", packets, frags);
+    CHECK((doneUs >= lastUs) && (doneUs <= (lastUs + 2 * STEP_US + 200)), "window ended after %uus, last fragment after %uus", doneUs, lastUs);
+    CHECK(loopMaxUs <= LOOP_MAX_US, "loop() took %uus", loopMaxUs);
+    CHECK(!sys.Radio.isBusy(), "busy after the window");
+
+    printf("no answer, channel hopping and timeout\n");
+    answer.frags = 0;
+    answer.sent  = 0;
+    doneUs = runWindow(addInverter(&cfg[1], 0x114172607951ULL), &windows, &packets, &loopMaxUs);
+    CHECK(1 == windows, "%u windows reported", windows);
+    CHECK(0 == packets, "%u fragments received", packets);
+    // the window is measured in ms from the start of listening
+    uint32_t winUs = (rf->hostHops[0].us - txUs) + RF_LISTEN_WINDOW_MS * 1000UL;
+    CHECK((doneUs + 1000 >= winUs) && (doneUs <= (winUs + 1000)), "window ended after %uus, expected %uus", doneUs, winUs);
+    CHECK(loopMaxUs <= LOOP_MAX_US, "loop() took %uus", loopMaxUs);
+    CHECK(rf->hostHops.size() > RF_CHANNELS, "%u hops", (uint32_t)rf->hostHops.size());
+    CHECK(rf->hostHops[0].ch == rfCh[(getChIdx(txCh) + RF_RX_OFFSET_DEFAULT) % RF_CHANNELS], "listening starts on channel %u", rf->hostHops[0].ch);
+    for(size_t i = 1; i < rf->hostHops.size(); i++) {
+        uint32_t dwell = rf->hostHops[i].us - rf->hostHops[i-1].us;
+        if((dwell < RF_CH_DWELL_US) || (dwell > (RF_CH_DWELL_US + STEP_US + 200))) {
+            CHECK(false, "hop %u after %uus, expected %uus", (uint32_t)i, dwell, RF_CH_DWELL_US);
+            break;
+        }
+        if(i >= RF_CHANNELS) {
+            uint8_t seen = 0;
+            for(size_t j = i - RF_CHANNELS + 1; j <= i; j++)
+                seen |= (1 << getChIdx(rf->hostHops[j].ch));
+            if(0x1f != seen) {
+                CHECK(false, "hops %u..%u don't cover all channels", (uint32_t)(i - RF_CHANNELS + 1), (uint32_t)i);
+                break;
+            }
+        }
+    }
+
+    printf("answer on the next channel\n");
+    answer.offset = (RF_RX_OFFSET_DEFAULT + 1) % RF_CHANNELS;
+    answer.delay  = RF_CH_DWELL_US + 1500; // within the second dwell
+    answer.frags  = frags;
+    answer.sent   = frags;
+    doneUs = runWindow(addInverter(&cfg[2], 0x114172607952ULL), &windows, &packets, &loopMaxUs);
+    lastUs = answer.delay + (frags - 1) * FRAG_US;
+    CHECK(1 == windows, "%u windows reported", windows);
+    CHECK(frags == packets, "%u of %u fragments received", packets, frags);
+    CHECK((doneUs >= lastUs) && (doneUs <= (lastUs + 2 * STEP_US + 200)), "window ended after %uus, last fragment after %uus", doneUs, lastUs);
+    CHECK(loopMaxUs <= LOOP_MAX_US, "loop() took %uus", loopMaxUs);
+
+    printf("incomplete answer\n");
+    answer.offset = RF_RX_OFFSET_DEFAULT;
+    answer.delay  = 1500;
+    answer.frags  = frags;
+    answer.sent   = frags - 1;
+    doneUs = runWindow(addInverter(&cfg[3], 0x114172607953ULL), &windows, &packets, &loopMaxUs);
+    CHECK(1 == windows, "%u windows reported", windows);
+    CHECK((frags - 1) == packets, "%u of %u fragments received", packets, frags - 1);
+    winUs = (rf->hostHops[0].us - txUs) + RF_LISTEN_WINDOW_MS * 1000UL;
+    CHECK((doneUs + 1000 >= winUs) && (doneUs <= (winUs + 1000)), "window ended after %uus, expected %uus", doneUs, winUs);
+
+    printf("retransmit burst\n");
+    answer.offset = RF_RX_OFFSET_DEFAULT;
+    answer.delay  = 1500;
+    answer.frags  = frags;
+    answer.sent   = frags;
+    uint8_t pid[3] = {SINGLE_FRAME, SINGLE_FRAME + 1, SINGLE_FRAME + 2}; // hm2ch: all three fragments
+    doneUs = runWindow(addInverter(&cfg[4], 0x114172607954ULL), &windows, &packets, &loopMaxUs, pid, 3);
+    CHECK(3 == txCnt, "%u of 3 requests sent", txCnt);
+    CHECK(1 == windows, "%u windows reported", windows);
+    CHECK(3 == packets, "%u of 3 fragments received", packets);
+    CHECK((doneUs >= answer.delay) && (doneUs <= (answer.delay + 2 * STEP_US + 200)), "window ended after %uus, last fragment after %uus", doneUs, answer.delay);
+    CHECK(loopMaxUs <= LOOP_MAX_US, "loop() took %uus", loopMaxUs);
+    CHECK(!sys.Radio.isBusy(), "busy after the window");
+
+    printf("%u errors\n", errors);
+    return (0 == errors) ? 0 : 1;
+}
@@ -0,0 +1,341 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+// replays the answers of a trace against HmRadio and the emulated NRF24
+// (stub/RF24.h) and compares the listen time with and without the learned
+// RX channel offset and answer delay (rfRxModel_t).
+// The trace is a capture of the DTU (/get_capture, capture.bin) or is
+// generated: every inverter sends most fragments on its own channel offset,
+// half of them on the default one, after its own delay of up to 10ms. Only
+// the first request of each payload is replayed, a fragment is received if
+// the radio listens on its channel at that time.
+// Exits with 1 if a learned state is worse than nothing learned: more than
+// MAX_LOSS_PCT less complete answers or a longer average listen time.
+//
+// usage: rxModelBench [-f capture.bin] [-n inverters] [-r requests] [-s seed]
+
+#include <Arduino.h>
+#include <algorithm>
+#include <vector>
+#include <unistd.h>
+#include "hm/hmSystem.h"
+
+uint64_t hostClockUs = 0;
+bool hostSerialOut   = false;
+HardwareSerial Serial;
+EspClass ESP;
+FS LittleFS;
+SPIClass SPI;
+
+#define STEP_US         50      // virtual time of one pass of the main loop
+#define GAP_US          20000   // between two requests
+#define TRACE_FRAMES    16      // fragments per request
+#define TRACE_INV       64      // inverters per trace
+#define SYN_FRAG_US     1200    // time between the fragments of a generated answer
+#define SYN_LOSS_PCT    5       // lost fragments of a generated answer
+#define SYN_OWN_PCT     85      // fragments on the channel offset of the inverter
+#define MAX_LOSS_PCT    1.0     // tolerated loss of complete answers by the learned states
+
+typedef HmSystem<MAX_NUM_INVERTERS> HmSystemType;
+
+static HmSystemType sys;
+static RF24 *rf;
+
+static const uint8_t rfCh[RF_CHANNELS] = {3, 23, 40, 61, 75};
+
+typedef struct {
+    uint32_t delay;  // [us] after the request
+    uint8_t offset;  // RX channel index relative to the TX channel
+    uint8_t len;
+    uint8_t buf[MAX_RF_PAYLOAD_SIZE];
+} traceFrame_t;
+
+typedef struct {
+    uint8_t iv;      // inverter of the trace
+    uint8_t cmd;
+    uint8_t cnt;
+    traceFrame_t frm[TRACE_FRAMES];
+} traceReq_t;
+
+static std::vector<traceReq_t> trace;
+static uint8_t traceIvFrags[TRACE_INV]; // fragments of the inverters answers, gives the type
+static uint8_t traceIvCnt = 0;
+static const traceReq_t *cur = NULL;
+
+enum {MODE_DEFAULTS = 0, MODE_NO_MODEL, MODE_LEARNED, MODE_CNT};
+static const char *modeNames[MODE_CNT] = {"nothing learned", "no RX model", "learned"};
+
+static uint8_t getChIdx(uint8_t ch) {
+    for(uint8_t i = 0; i < RF_CHANNELS; i++) {
+        if(rfCh[i] == ch)
+            return i;
+    }
+    return 0xff;
+}
+
+// puts the answer of the replayed request on air
+static void onTx(uint8_t ch, const uint8_t buf[], uint8_t len) {
+    if((NULL == cur) || (TX_REQ_INFO != buf[0]))
+        return;
+    uint8_t txIdx = getChIdx(ch);
+    for(uint8_t i = 0; i < cur->cnt; i++) {
+        const traceFrame_t *f = &cur->frm[i];
+        uint8_t frm[MAX_RF_PAYLOAD_SIZE];
+        memcpy(frm, f->buf, f->len);
+        memcpy(&frm[1], &buf[1], 8); // inverter and DTU id of the replay
+        frm[f->len - 1] = ah::crc8(frm, f->len - 1);
+        rf->hostPutOnAir(hostClockUs + f->delay, rfCh[(txIdx + f->offset) % RF_CHANNELS], frm, f->len);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// the first request of each payload and its answers, requests of other
+// inverters end an answer
+static bool readCapture(const char *path) {
+    FILE *fp = fopen(path, "rb");
+    if(NULL == fp) {
+        fprintf(stderr, "can't open %s\n", path);
+        return false;
+    }
+    capHeader_t hdr;
+    if((1 != fread(&hdr, sizeof(hdr), 1, fp)) || (CAPTURE_MAGIC != hdr.magic) || (hdr.next >= CAPTURE_MAX_RECORDS) || (hdr.cnt > CAPTURE_MAX_RECORDS)) {
+        fprintf(stderr, "%s is no capture\n", path);
+        fclose(fp);
+        return false;
+    }
+
+    uint8_t ivAddr[TRACE_INV][4];
+    traceReq_t req;
+    uint32_t txTs = 0;
+    uint8_t txIdx = 0;
+    bool open = false;
+    for(uint16_t n = 0; n < hdr.cnt; n++) {
+        capRecord_t r;
+        uint16_t idx = (hdr.next + CAPTURE_MAX_RECORDS - hdr.cnt + n) % CAPTURE_MAX_RECORDS;
+        fseek(fp, sizeof(capHeader_t) + idx * sizeof(capRecord_t), SEEK_SET);
+        if(1 != fread(&r, sizeof(r), 1, fp))
+            break;
+
+        if(r.flags & CAPTURE_TX) {
+            if(open && (0 != req.cnt))
+                trace.push_back(req);
+            open = false;
+            if((r.flags & CAPTURE_RETRANSMIT) || (TX_REQ_INFO != r.data[0]) || (ALL_FRAMES != r.data[9]) || (0xff == getChIdx(r.ch)))
+                continue; // replayed are full requests of HM inverters only
+            uint8_t iv = 0;
+            for(; iv < traceIvCnt; iv++) {
+                if(0 == memcmp(ivAddr[iv], &r.data[1], 4))
+                    break;
+            }
+            if(iv == traceIvCnt) {
+                if(TRACE_INV == traceIvCnt)
+                    continue;
+                memcpy(ivAddr[traceIvCnt++], &r.data[1], 4);
+            }
+            memset(&req, 0, sizeof(req));
+            req.iv  = iv;
+            req.cmd = r.data[10];
+            txTs    = r.ts;
+            txIdx   = getChIdx(r.ch);
+            open    = true;
+        } else if(open && !(r.flags & CAPTURE_CRC_FAIL) && (req.cnt < TRACE_FRAMES) && (r.len > 10) && (0xff != getChIdx(r.ch))) {
+            if((TX_REQ_INFO + ALL_FRAMES) != r.data[0])
+                continue;
+            traceFrame_t *f = &req.frm[req.cnt++];
+            f->delay  = r.ts - txTs;
+            f->offset = (getChIdx(r.ch) + RF_CHANNELS - txIdx) % RF_CHANNELS;
+            f->len    = r.len;
+            memcpy(f->buf, r.data, r.len);
+            if((RealTimeRunData_Debug == req.cmd) && (r.data[9] > ALL_FRAMES))
+                traceIvFrags[req.iv] = r.data[9] & 0x7f;
+        }
+    }
+    if(open && (0 != req.cnt))
+        trace.push_back(req);
+    fclose(fp);
+    return true;
+}
+
+// every inverter sends most fragments on its own channel offset after its own delay
+static void generate(uint8_t inverters, uint32_t requests) {
+    uint8_t offset[TRACE_INV];
+    uint32_t delay[TRACE_INV];
+    traceIvCnt = inverters;
+    for(uint8_t i = 0; i < inverters; i++) {
+        offset[i] = (0 == (i % 2)) ? RF_RX_OFFSET_DEFAULT : random(RF_CHANNELS);
+        delay[i]  = 1000 + random(9000);
+        traceIvFrags[i] = (HM2CH_PAYLOAD_LEN + 2 + 15) / 16;
+    }
+
+    for(uint32_t n = 0; n < requests; n++) {
+        traceReq_t req;
+        memset(&req, 0, sizeof(req));
+        req.iv  = n % inverters;
+        req.cmd = RealTimeRunData_Debug;
+        uint32_t t  = delay[req.iv] + random(1000);
+        uint8_t frags = traceIvFrags[req.iv];
+        for(uint8_t i = 1; i <= frags; i++, t += SYN_FRAG_US + random(200)) {
+            if(random(100) < SYN_LOSS_PCT)
+                continue;
+            traceFrame_t *f = &req.frm[req.cnt++];
+            f->delay  = t;
+            f->offset = (random(100) < SYN_OWN_PCT) ? offset[req.iv] : random(RF_CHANNELS);
+            f->len    = 27;
+            memset(f->buf, 0, f->len);
+            f->buf[0] = TX_REQ_INFO + ALL_FRAMES;
+            f->buf[9] = (i == frags) ? (ALL_FRAMES | i) : i;
+        }
+        trace.push_back(req);
+    }
+}
+
+//-----------------------------------------------------------------------------
+typedef struct {
+    std::vector<uint32_t> listenUs;
+    uint32_t frames;
+    uint32_t heard;
+    uint32_t complete;
+} result_t;
+
+static void replay(uint8_t mode, cfgIv_t cfg[], result_t *res) {
+    static const uint8_t types[] = {0x21, 0x21, 0x21, 0x41, 0x61}; // by the number of fragments
+    Inverter<> *iv[TRACE_INV];
+    rfChStat_t stat[RF_CHANNELS];
+    rfRxModel_t model;
+    rfWindow_t win[RF_LAT_CMDS];
+
+    for(uint8_t i = 0; i < traceIvCnt; i++) {
+        uint8_t frags = (traceIvFrags[i] > 4) ? 4 : traceIvFrags[i];
+        memset(&cfg[i], 0, sizeof(cfgIv_t));
+        cfg[i].enabled    = true;
+        cfg[i].serial.u64 = 0x110000000000ULL | ((uint64_t)types[frags] << 32) | (0x10000000 + i);
+        iv[i] = sys.addInverter(&cfg[i]);
+        if(NULL == iv[i]) {
+            fprintf(stderr, "too many inverters\n");
+            exit(1);
+        }
+    }
+    // initial state of the learned values
+    memcpy(stat, iv[0]->rfStat, sizeof(stat));
+    memcpy(&model, &iv[0]->rfModel, sizeof(model));
+    memcpy(win, iv[0]->rfWin, sizeof(win));
+
+    res->frames   = 0;
+    res->heard    = 0;
+    res->complete = 0;
+    for(size_t n = 0; n < trace.size(); n++) {
+        cur = &trace[n];
+        Inverter<> *inv = iv[cur->iv];
+        if(MODE_LEARNED != mode)
+            memcpy(&inv->rfModel, &model, sizeof(model));
+        if(MODE_DEFAULTS == mode) {
+            memcpy(inv->rfStat, stat, sizeof(stat));
+            memcpy(inv->rfWin, win, sizeof(win));
+        }
+
+        uint64_t txUs = hostClockUs;
+        sys.Radio.prepareDevInformCmd(inv, cur->cmd, 1700000000, 0, false);
+        uint64_t end = txUs + 2 * RF_LISTEN_WINDOW_MS * 1000UL;
+        while(hostClockUs < end) {
+            if(sys.loop())
+                break;
+            rf->hostPoll();
+            hostAdvanceUs(STEP_US);
+        }
+        res->listenUs.push_back(hostClockUs - txUs);
+
+        uint8_t heard = 0;
+        while(NULL != sys.getPacket()) {
+            heard++;
+            sys.popPacket();
+        }
+        res->frames += cur->cnt;
+        res->heard  += heard;
+        if(heard >= cur->cnt)
+            res->complete++;
+
+        // nothing of this answer is left for the next request
+        rf->hostClearAir();
+        for(uint64_t gap = hostClockUs + GAP_US; hostClockUs < gap; hostAdvanceUs(STEP_US)) {
+            sys.loop();
+            rf->hostPoll();
+        }
+    }
+    cur = NULL;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = NULL;
+    uint32_t requests = 2000, seed = 1;
+    uint8_t inverters = 8;
+    int opt;
+    while(-1 != (opt = getopt(argc, argv, "f:n:r:s:"))) {
+        switch(opt) {
+            case 'f': path      = optarg; break;
+            case 'n': inverters = atoi(optarg); break;
+            case 'r': requests  = atoi(optarg); break;
+            case 's': seed      = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-f capture.bin] [-n inverters] [-r requests] [-s seed]\n", argv[0]);
+                return 1;
+        }
+    }
+    if((0 == inverters) || (inverters > (MAX_NUM_INVERTERS / MODE_CNT)) || (inverters > TRACE_INV)) {
+        fprintf(stderr, "1 to %d inverters\n", std::min(MAX_NUM_INVERTERS / MODE_CNT, TRACE_INV));
+        return 1;
+    }
+    randomSeed(seed);
+
+    if(NULL != path) {
+        if(!readCapture(path))
+            return 1;
+        if((traceIvCnt * MODE_CNT) > MAX_NUM_INVERTERS) {
+            fprintf(stderr, "too many inverters in the capture\n");
+            return 1;
+        }
+    } else
+        generate(inverters, requests);
+    if(trace.empty()) {
+        fprintf(stderr, "no request to replay\n");
+        return 1;
+    }
+    printf("%u requests of %u inverters %s\n", (uint32_t)trace.size(), traceIvCnt, (NULL != path) ? path : "(generated)");
+
+    sys.setup(RF24_PA_LOW, DEF_IRQ_PIN, DEF_CE_PIN, DEF_CS_PIN, DEF_SCLK_PIN, DEF_MOSI_PIN, DEF_MISO_PIN);
+    rf = hostRf24();
+    rf->hostIrq  = []() { sys.Radio.handleIntr(); };
+    rf->hostOnTx = onTx;
+
+    static cfgIv_t cfg[MODE_CNT][TRACE_INV];
+    double completePct[MODE_CNT], avgMs[MODE_CNT];
+    printf("%-16s %9s %9s %9s %10s\n", "", "avg [ms]", "p50 [ms]", "p95 [ms]", "complete");
+    for(uint8_t mode = 0; mode < MODE_CNT; mode++) {
+        result_t res;
+        replay(mode, cfg[mode], &res);
+        std::vector<uint32_t> &l = res.listenUs;
+        std::sort(l.begin(), l.end());
+        uint64_t sum = 0;
+        for(size_t i = 0; i < l.size(); i++)
+            sum += l[i];
+        completePct[mode] = 100.0 * res.complete / l.size();
+        avgMs[mode]       = (double)sum / l.size() / 1000;
+        printf("%-16s %9.2f %9.2f %9.2f %9.1f%%   %u of %u fragments\n", modeNames[mode],
+            avgMs[mode], l[l.size() / 2] / 1000.0, l[(l.size() * 95) / 100] / 1000.0,
+            completePct[mode], res.heard, res.frames);
+    }
+
+    uint8_t errors = 0;
+    for(uint8_t mode = MODE_NO_MODEL; mode < MODE_CNT; mode++) {
+        if((completePct[mode] + MAX_LOSS_PCT) < completePct[MODE_DEFAULTS]) {
+            printf("FAIL %s: less complete answers than %s\n", modeNames[mode], modeNames[MODE_DEFAULTS]);
+            errors++;
+        }
+        if(avgMs[mode] > avgMs[MODE_DEFAULTS]) {
+            printf("FAIL %s: longer listen time than %s\n", modeNames[mode], modeNames[MODE_DEFAULTS]);
+            errors++;
+        }
+    }
+    return (0 == errors) ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_ARDUINO_H__
+#define __HOST_ARDUINO_H__
+
+// minimal Arduino core for the host programs, time is a virtual clock which
+// is advanced by the program (hostAdvanceUs)
+
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <functional>
+
+#define IRAM_ATTR
+#define PROGMEM
+#define HEX 16
+#define DEC 10
+#define PSTR(x) (x)
+#define INPUT_PULLUP 2
+#define FALLING 2
+
+typedef uint8_t byte;
+class __FlashStringHelper;
+#define F(x) (reinterpret_cast<const __FlashStringHelper*>(x))
+inline uint8_t pgm_read_byte(const void *p) { return *(const uint8_t*)p; }
+inline uint16_t pgm_read_word(const void *p) { return *(const uint16_t*)p; }
+inline uint32_t pgm_read_dword(const void *p) { return *(const uint32_t*)p; }
+
+class String {
+    public:
+        String() {}
+        String(const char *c) : s(c ? c : "") {}
+        String(const __FlashStringHelper *c) : s((const char*)c) {}
+        String(const std::string &c) : s(c) {}
+        String(char c) : s(1, c) {}
+        String(int v, int base = DEC) { fmt((long long)v, base); }
+        String(unsigned int v, int base = DEC) { fmt((unsigned long long)v, base); }
+        String(long v, int base = DEC) { fmt((long long)v, base); }
+        String(unsigned long v, int base = DEC) { fmt((unsigned long long)v, base); }
+        String(long long v, int base = DEC) { fmt(v, base); }
+        String(unsigned long long v, int base = DEC) { fmt(v, base); }
+        String(unsigned char v, int base = DEC) { fmt((unsigned long long)v, base); }
+        String(float v, int dec = 2) { fmt((double)v, dec); }
+        String(double v, int dec = 2) { fmt(v, dec); }
+
+        const char *c_str() const { return s.c_str(); }
+        unsigned length() const { return s.size(); }
+        String substring(unsigned a, unsigned b = (unsigned)-1) const { return (a >= s.size()) ? String() : String(s.substr(a, b - a)); }
+        long toInt() const { return atol(s.c_str()); }
+        float toFloat() const { return atof(s.c_str()); }
+        void toCharArray(char *b, unsigned n) const { strncpy(b, s.c_str(), n); if(n) b[n - 1] = 0; }
+        bool operator==(const String &o) const { return s == o.s; }
+        bool operator==(const char *o) const { return s == o; }
+        bool operator!=(const String &o) const { return s != o.s; }
+        bool operator!=(const char *o) const { return s != o; }
+        String &operator+=(const String &o) { s += o.s; return *this; }
+        String &operator+=(const char *o) { s += o; return *this; }
+        String &operator+=(char o) { s += o; return *this; }
+        char operator[](unsigned i) const { return s[i]; }
+
+    private:
+        void fmt(long long v, int base) {
+            if(HEX == base) fmt((unsigned long long)v, base);
+            else s = std::to_string(v);
+        }
+        void fmt(unsigned long long v, int base) {
+            char b[24];
+            snprintf(b, sizeof(b), (HEX == base) ? "%llx" : "%llu", v);
+            s = b;
+        }
+        void fmt(double v, int dec) {
+            char b[40];
+            snprintf(b, sizeof(b), "%.*f", dec, v);
+            s = b;
+        }
+        std::string s;
+};
+inline String operator+(const String &a, const String &b) { String r(a); r += b; return r; }
+inline String operator+(const String &a, const char *b) { String r(a); r += b; return r; }
+inline String operator+(const char *a, const String &b) { String r(a); r += b; return r; }
+inline String operator+(const String &a, const __FlashStringHelper *b) { return a + String(b); }
+inline String operator+(const __FlashStringHelper *a, const String &b) { return String(a) + b; }
+
+// Serial output is only printed if enabled
+extern bool hostSerialOut;
+class Print {
+    public:
+        size_t print(const String &s) { return out(s.c_str()); }
+        size_t print(const char *s) { return out(s); }
+        size_t print(const __FlashStringHelper *s) { return out((const char*)s); }
+        size_t print(unsigned long long v, int base = DEC) { return print(String(v, base)); }
+        template <class T>
+        size_t println(const T &v) { size_t n = print(v); return n + out("\n"); }
+        size_t println(void) { return out("\n"); }
+        size_t write(const uint8_t *buf, size_t len) { return len; }
+    private:
+        size_t out(const char *s) { if(hostSerialOut) fputs(s, stdout); return strlen(s); }
+};
+class Stream : public Print {
+    public:
+        int available() { return 0; }
+        int read() { return -1; }
+        size_t readBytes(uint8_t*, size_t) { return 0; }
+};
+class HardwareSerial : public Stream {
+    public:
+        void begin(unsigned long) {}
+        operator bool() { return true; }
+        void flush() {}
+};
+extern HardwareSerial Serial;
+
+// virtual clock
+extern uint64_t hostClockUs;
+inline void hostAdvanceUs(uint32_t us) { hostClockUs += us; }
+inline uint32_t millis(void) { return (uint32_t)(hostClockUs / 1000); }
+inline uint32_t micros(void) { return (uint32_t)hostClockUs; }
+inline void yield(void) {}
+inline void delay(uint32_t ms) { hostClockUs += (uint64_t)ms * 1000; }
+inline void delayMicroseconds(uint32_t us) { hostClockUs += us; }
+
+inline void pinMode(uint8_t pin, uint8_t mode) {}
+inline void attachInterrupt(uint8_t irq, void (*cb)(void), int mode) {}
+#define digitalPinToInterrupt(p) (p)
+
+inline long random(long max) { return (max > 0) ? (rand() % max) : 0; }
+inline long random(long min, long max) { return (max > min) ? (min + rand() % (max - min)) : min; }
+inline void randomSeed(unsigned long seed) { srand(seed); }
+
+class EspClass {
+    public:
+        uint32_t getChipId() { return 0x123456; }
+        uint32_t getFreeHeap() { return 0; }
+        uint32_t getMaxFreeBlockSize() { return 0; }
+        void restart() {}
+};
+extern EspClass ESP;
+
+#endif /*__HOST_ARDUINO_H__*/
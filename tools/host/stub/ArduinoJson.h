@@ -0,0 +1,60 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_ARDUINO_JSON_H__
+#define __HOST_ARDUINO_JSON_H__
+
+// compile only: the host programs neither read nor write settings, every
+// document is empty
+
+#include <Arduino.h>
+#include <type_traits>
+
+class JsonVariant {
+    public:
+        JsonVariant() {}
+        template <class T> JsonVariant &operator=(const T &v) { return *this; }
+        template <class T> JsonVariant operator[](const T &key) const { return JsonVariant(); }
+        template <class T> T as(void) const { return T(); }
+        template <class T> bool is(void) const { return false; }
+        template <class T> operator T() const { return T(); }
+        template <class T> bool containsKey(const T &key) const { return false; }
+        template <class T> JsonVariant createNestedObject(const T &key) { return JsonVariant(); }
+        template <class T> JsonVariant createNestedArray(const T &key) { return JsonVariant(); }
+        JsonVariant createNestedObject(void) { return JsonVariant(); }
+        JsonVariant createNestedArray(void) { return JsonVariant(); }
+        template <class T> bool add(const T &v) { return false; }
+        template <class T> T to(void) { return T(); }
+        size_t size(void) const { return 0; }
+        bool isNull(void) const { return true; }
+        bool overflowed(void) const { return false; }
+        size_t memoryUsage(void) const { return 0; }
+        size_t capacity(void) const { return 0; }
+        void clear(void) {}
+        void shrinkToFit(void) {}
+};
+typedef JsonVariant JsonObject;
+typedef JsonVariant JsonArray;
+typedef JsonVariant JsonDocument;
+
+class DynamicJsonDocument : public JsonVariant {
+    public:
+        DynamicJsonDocument(size_t capacity) {}
+};
+
+class DeserializationError {
+    public:
+        operator bool() const { return true; }
+        const char *c_str(void) const { return "NoFileSystem"; }
+};
+template <class A, class B> DeserializationError deserializeJson(A &doc, B &in) { return DeserializationError(); }
+template <class A, class B> size_t serializeJson(const A &doc, B &out) { return 0; }
+
+template <class T>
+inline bool operator==(const JsonVariant &a, const T &b) { return false; }
+template <class T>
+inline bool operator!=(const JsonVariant &a, const T &b) { return true; }
+
+#endif /*__HOST_ARDUINO_JSON_H__*/
@@ -0,0 +1,13 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_ESP_ASYNC_WEB_SERVER_H__
+#define __HOST_ESP_ASYNC_WEB_SERVER_H__
+
+// compile only: the host programs have no web server
+
+class AsyncWebServerRequest;
+
+#endif /*__HOST_ESP_ASYNC_WEB_SERVER_H__*/
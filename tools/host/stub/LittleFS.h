@@ -0,0 +1,53 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_LITTLEFS_H__
+#define __HOST_LITTLEFS_H__
+
+// compile only: the host programs have no file system, every open fails
+
+#include <Arduino.h>
+
+enum SeekMode {SeekSet = 0, SeekCur, SeekEnd};
+
+class File : public Stream {
+    public:
+        operator bool() const { return false; }
+        void close(void) {}
+        size_t size(void) const { return 0; }
+        size_t position(void) const { return 0; }
+        bool seek(uint32_t pos, SeekMode mode = SeekSet) { return false; }
+        size_t read(uint8_t *buf, size_t len) { return 0; }
+        int read(void) { return -1; }
+        size_t write(const uint8_t *buf, size_t len) { return 0; }
+        size_t write(uint8_t c) { return 0; }
+        void flush(void) {}
+};
+
+class LittleFSConfig {
+    public:
+        void setAutoFormat(bool enable) {}
+};
+
+typedef struct {
+    size_t totalBytes;
+    size_t usedBytes;
+} FSInfo;
+
+class FS {
+    public:
+        bool begin(void) { return false; }
+        void end(void) {}
+        bool format(void) { return false; }
+        bool setConfig(const LittleFSConfig &cfg) { return true; }
+        bool info(FSInfo &info) { info.totalBytes = info.usedBytes = 0; return true; }
+        File open(const char *path, const char *mode = "r") { return File(); }
+        bool exists(const char *path) { return false; }
+        bool remove(const char *path) { return false; }
+        bool rename(const char *from, const char *to) { return false; }
+};
+extern FS LittleFS;
+
+#endif /*__HOST_LITTLEFS_H__*/
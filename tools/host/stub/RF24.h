@@ -0,0 +1,188 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_RF24_H__
+#define __HOST_RF24_H__
+
+// NRF24 on the virtual clock: the host program puts frames on air
+// (hostPutOnAir), a frame is received if the NRF24 listens on its channel
+// when it arrives. Every SPI access costs HOST_RF24_SPI_US, a request is on
+// air for HOST_RF24_TX_US. The interrupt line is the callback hostIrq,
+// hostPoll() has to be called while the virtual clock advances.
+
+#include <Arduino.h>
+#include <vector>
+#include "SPI.h"
+
+#define HOST_RF24_SPI_US    20      // one SPI transaction
+#define HOST_RF24_TX_US     1000    // request incl. ACK
+#define HOST_RF24_FIFO      3       // RX FIFO of the NRF24
+
+typedef enum { RF24_PA_MIN = 0, RF24_PA_LOW, RF24_PA_HIGH, RF24_PA_MAX, RF24_PA_ERROR } rf24_pa_dbm_e;
+typedef enum { RF24_1MBPS = 0, RF24_2MBPS, RF24_250KBPS } rf24_datarate_e;
+typedef enum { RF24_CRC_DISABLED = 0, RF24_CRC_8, RF24_CRC_16 } rf24_crclength_e;
+
+typedef struct {
+    uint64_t us;    // arrival
+    uint8_t ch;
+    uint8_t len;
+    uint8_t buf[32];
+} hostRf24Frame_t;
+
+typedef struct {
+    uint64_t us;
+    uint8_t ch;
+} hostRf24Hop_t;
+
+class RF24;
+// last created NRF24, the host program has no access to the one of HmRadio otherwise
+inline RF24 *&hostRf24(void) {
+    static RF24 *rf = NULL;
+    return rf;
+}
+
+class RF24 {
+    public:
+        RF24(uint16_t ce, uint16_t cs, uint32_t spiSpeed = 0) {
+            mCh        = 0;
+            mListening = false;
+            mTxDoneUs  = 0;
+            hostHeard  = 0;
+            hostMissed = 0;
+            hostRf24() = this;
+        }
+
+        // host side
+        std::function<void(void)> hostIrq;
+        // called with every request which is sent
+        std::function<void(uint8_t ch, const uint8_t buf[], uint8_t len)> hostOnTx;
+        std::vector<hostRf24Hop_t> hostHops; // channel changes while listening
+        uint32_t hostHeard;
+        uint32_t hostMissed; // wrong channel, not listening or FIFO full
+
+        void hostPutOnAir(uint64_t us, uint8_t ch, const uint8_t buf[], uint8_t len) {
+            hostRf24Frame_t f;
+            f.us  = us;
+            f.ch  = ch;
+            f.len = (len > 32) ? 32 : len;
+            memcpy(f.buf, buf, f.len);
+            std::vector<hostRf24Frame_t>::iterator it = mAir.begin();
+            while((it != mAir.end()) && (it->us <= us))
+                ++it;
+            mAir.insert(it, f);
+        }
+
+        void hostClearAir(void) {
+            mAir.clear();
+        }
+
+        // delivers the frames which arrived until now, raises the interrupt
+        void hostPoll(void) {
+            while(!mAir.empty() && (mAir.front().us <= hostClockUs)) {
+                hostRf24Frame_t *f = &mAir.front();
+                if(mListening && (f->ch == mCh) && (mFifo.size() < HOST_RF24_FIFO)) {
+                    mFifo.push_back(*f);
+                    hostHeard++;
+                    irq();
+                } else
+                    hostMissed++;
+                mAir.erase(mAir.begin());
+            }
+            if((0 != mTxDoneUs) && (mTxDoneUs <= hostClockUs)) {
+                mTxDoneUs = 0;
+                irq();
+            }
+        }
+
+        // NRF24
+        bool begin(SPIClass *spi, uint16_t ce, uint16_t cs) { return true; }
+        bool available(void) { spi(); return !mFifo.empty(); }
+        bool available(uint8_t *pipe) { return available(); }
+        void enableDynamicPayloads(void) {}
+        uint8_t flush_tx(void) { spi(); return 0; }
+        rf24_datarate_e getDataRate(void) { return RF24_250KBPS; }
+        uint8_t getDynamicPayloadSize(void) { spi(); return mFifo.empty() ? 0 : mFifo.front().len; }
+        bool isChipConnected(void) { return true; }
+        bool isPVariant(void) { return true; }
+        void maskIRQ(bool tx, bool fail, bool rx) {}
+        void openReadingPipe(uint8_t pipe, const uint8_t *addr) {}
+        void openWritingPipe(const uint8_t *addr) { spi(); }
+        void printPrettyDetails(void) {}
+        void setAddressWidth(uint8_t width) {}
+        void setAutoAck(bool enable) {}
+        void setAutoAck(uint8_t pipe, bool enable) {}
+        void setCRCLength(rf24_crclength_e len) {}
+        bool setDataRate(rf24_datarate_e rate) { return true; }
+        void setPALevel(uint8_t level, bool lnaEnable = true) { spi(); }
+        void setRetries(uint8_t delay, uint8_t count) {}
+        void whatHappened(bool &txOk, bool &txFail, bool &rxReady) { spi(); txOk = txFail = rxReady = false; }
+
+        void read(void *buf, uint8_t len) {
+            spi();
+            if(mFifo.empty())
+                return;
+            memcpy(buf, mFifo.front().buf, (len > mFifo.front().len) ? mFifo.front().len : len);
+            mFifo.erase(mFifo.begin());
+        }
+
+        void setChannel(uint8_t ch) {
+            spi();
+            mCh = ch;
+            if(mListening)
+                hostHops.push_back({hostClockUs, ch});
+        }
+
+        void startListening(void) {
+            spi();
+            mListening = true;
+            hostHops.push_back({hostClockUs, mCh});
+        }
+
+        void stopListening(void) {
+            spi();
+            mListening = false;
+        }
+
+        // blocks until the request is sent
+        bool write(const void *buf, uint8_t len) {
+            spi();
+            tx((const uint8_t*)buf, len);
+            hostAdvanceUs(HOST_RF24_TX_US);
+            hostPoll();
+            return true;
+        }
+
+        // the interrupt signals the end of the transmission
+        bool startWrite(const void *buf, uint8_t len, bool multicast) {
+            spi();
+            tx((const uint8_t*)buf, len);
+            mTxDoneUs = hostClockUs + HOST_RF24_TX_US;
+            return true;
+        }
+
+    private:
+        void spi(void) {
+            hostAdvanceUs(HOST_RF24_SPI_US);
+            hostPoll();
+        }
+
+        void tx(const uint8_t buf[], uint8_t len) {
+            if(hostOnTx)
+                hostOnTx(mCh, buf, len);
+        }
+
+        void irq(void) {
+            if(hostIrq)
+                hostIrq();
+        }
+
+        uint8_t mCh;
+        bool mListening;
+        uint64_t mTxDoneUs;
+        std::vector<hostRf24Frame_t> mAir;
+        std::vector<hostRf24Frame_t> mFifo;
+};
+
+#endif /*__HOST_RF24_H__*/
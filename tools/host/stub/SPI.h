@@ -0,0 +1,18 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_SPI_H__
+#define __HOST_SPI_H__
+
+// compile only
+
+class SPIClass {
+    public:
+        void begin(void) {}
+        void begin(int8_t sclk, int8_t miso, int8_t mosi, int8_t cs) {}
+};
+extern SPIClass SPI;
+
+#endif /*__HOST_SPI_H__*/
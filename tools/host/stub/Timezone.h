@@ -0,0 +1,41 @@
+//-----------------------------------------------------------------------------
+// 2023 Ahoy, https://ahoydtu.de
+// Creative Commons - http://creativecommons.org/licenses/by-nc-sa/3.0/de/
+//-----------------------------------------------------------------------------
+
+#ifndef __HOST_TIMEZONE_H__
+#define __HOST_TIMEZONE_H__
+
+// the host programs work in UTC, TimeLib is part of this header
+
+#include <Arduino.h>
+#include <ctime>
+
+enum week_t {Last, First, Second, Third, Fourth};
+enum dow_t {Sun = 1, Mon, Tue, Wed, Thu, Fri, Sat};
+enum month_t {Jan = 1, Feb, Mar, Apr, May, Jun, Jul, Aug, Sep, Oct, Nov, Dec};
+
+typedef struct {
+    char abbrev[6];
+    uint8_t week;
+    uint8_t dow;
+    uint8_t month;
+    uint8_t hour;
+    int offset;
+} TimeChangeRule;
+
+class Timezone {
+    public:
+        Timezone(TimeChangeRule dstStart, TimeChangeRule stdStart) {}
+        uint32_t toLocal(uint32_t utc) { return utc; }
+};
+
+inline struct tm hostTm(time_t t) { struct tm r; gmtime_r(&t, &r); return r; }
+inline int year(time_t t)   { return hostTm(t).tm_year + 1900; }
+inline int month(time_t t)  { return hostTm(t).tm_mon + 1; }
+inline int day(time_t t)    { return hostTm(t).tm_mday; }
+inline int hour(time_t t)   { return hostTm(t).tm_hour; }
+inline int minute(time_t t) { return hostTm(t).tm_min; }
+inline int second(time_t t) { return hostTm(t).tm_sec; }
+
+#endif /*__HOST_TIMEZONE_H__*/